@@ -0,0 +1,38 @@
+#!/bin/sh
+
+# Run each test_<name>.awk which has expected output test_<name>.out and compare.
+# Input is test_<name>.data if present, otherwise emp.data.
+#
+# Each test is run with the default settings and again with --nocompile, --novm and
+# --nodfa so the compiled, virtual machine and dfa code paths are checked against
+# the original ones.
+#
+# Usage: run_tests.sh [<awk>]   (default ../../bin/CAwk)
+
+awk=${1:-../../bin/CAwk}
+
+cd `dirname $0`
+
+failed=0
+
+for out in test_*.out; do
+  name=`basename $out .out`
+
+  data=emp.data
+
+  if [ -f $name.data ]; then
+    data=$name.data
+  fi
+
+  for opt in "" --nocompile --novm --nodfa; do
+    if $awk $opt -f $name.awk $data 2>&1 | cmp -s - $out; then
+      echo "PASS $name $opt"
+    else
+      echo "FAIL $name $opt"
+
+      failed=1
+    fi
+  done
+done
+
+exit $failed
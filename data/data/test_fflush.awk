@@ -0,0 +1,17 @@
+BEGIN {
+  out1 = "test_fflush1.tmp"
+  out2 = "test_fflush2.tmp"
+  system("rm -f " out1 " " out2)
+  print "one" > out1
+  fflush(out1)
+  while ((getline line < out1) > 0) print "read " out1 ": " line
+  print "two" > out2
+  fflush()
+  while ((getline line < out2) > 0) print "read " out2 ": " line
+  print "before system"
+  fflush("/dev/stdout")
+  system("echo system")
+  close(out1)
+  close(out2)
+  system("rm -f " out1 " " out2)
+}
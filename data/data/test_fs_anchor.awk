@@ -0,0 +1,3 @@
+BEGIN { FS = "^ab|ab$|-" }
+{ printf "%d:", NF; for (i = 1; i <= NF; ++i) printf " [%s]", $i; print "" }
+{ n = split($0, a, "abcd|c|x*"); printf "%d:", n; for (i = 1; i <= n; ++i) printf " [%s]", a[i]; print "" }
@@ -0,0 +1,2 @@
+BEGIN { FS = "[,;] *" }
+{ printf "%d:", NF; for (i = 1; i <= NF; ++i) printf " [%s]", $i; print "" }
@@ -0,0 +1,19 @@
+BEGIN {
+  file = "test_getline.data"
+  while ((getline line < file) > 0) print "newline: [" line "]"
+  close(file)
+  RS = ";"
+  while ((getline line < file) > 0) print "char: [" line "]"
+  close(file)
+  RS = ""
+  while ((getline line < file) > 0) print "paragraph: [" line "]"
+  close(file)
+  RS = "[;\n]+"
+  while ((getline < file) > 0) print "regexp: [" $0 "] " NF
+  close(file)
+  RS = "\n"
+  getline a < file
+  getline b < file
+  print "next: [" a "] [" b "]"
+  close(file)
+}
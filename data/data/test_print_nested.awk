@@ -0,0 +1,4 @@
+function f(s) { print "nested " s; return s }
+function g(s) { printf "nested %s\n", s; return s }
+{ print $1, f($3) }
+{ printf "%s %s\n", $1, g($3) }
@@ -0,0 +1 @@
+{ printf "%c|%c|%c|%c|%3c|%-3c|%c|%*c\n", $1, $2, "65", 65, $1, 66, 0, 2, 0 }
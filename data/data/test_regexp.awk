@@ -0,0 +1,8 @@
+/^M/                    { print "^M:", $1 }
+/a(r|th)/               { print "a(r|th):", $1 }
+/[[:digit:]]{2}$/       { print "digits$:", $1 }
+/e.*s|ty/               { print "e.*s|ty:", $1 }
+$1 ~ /^[A-Z][a-z]+y$/   { print "~:", $1 }
+$1 !~ /y$|^[BD]/        { print "!~:", $1 }
+$2 ~ "^[45]\\.(00|25)$" { print "dynamic:", $1 }
+$1 ~ /^(Ma|Da)?[nr]?[ky]/ { print "optional:", $1 }
@@ -0,0 +1,2 @@
+{ n = split($0, a, /[0-9]+/); printf "%d:", n; for (i = 1; i <= n; ++i) printf " [%s]", a[i]; print "" }
+{ n = split($0, a, ", *"); printf "%d:", n; for (i = 1; i <= n; ++i) printf " [%s]", a[i]; print "" }
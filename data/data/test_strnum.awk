@@ -0,0 +1,3 @@
+BEGIN { FS = "\t"; a = ("10" == "10.0"); b = ("0" ? "true" : "false"); c = ("" ? "true" : "false"); print a, b, c }
+{ a = ($2 == 4); b = ($2 < 10); c = ($3 ? "true" : "false"); d = ($2 == "4.00"); print $1, a, b, c, d }
+{ x = $3; y = x ""; a = (x == 10.0); b = (y == 10.0); c = (x ? "x" : "!x"); print $1, a, b, c }
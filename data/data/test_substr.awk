@@ -0,0 +1 @@
+{ print substr($1, 2, 1e20), substr($1, 2, 3), substr($1, 3), substr($1, 1, 1e300 * 1e300) }
@@ -7,13 +7,15 @@
 #include <CAwkValue.h>
 #include <CAwkFunction.h>
 #include <CAwkAction.h>
+#include <CAwkProgram.h>
 #include <CAwkPattern.h>
 #include <CAwkOperator.h>
+#include <CAwkFieldSplit.h>
+#include <CAwkFormat.h>
 
 #include <CStrParse.h>
 #include <CFile.h>
 #include <memory>
-#include <optional>
 
 class CAwkPatternAction {
  public:
@@ -32,11 +34,15 @@ class CAwkPatternAction {
  public:
  ~CAwkPatternAction() { }
 
+  CAwkPatternPtr getPattern() const { return pattern_; }
+
   bool isBegin() const;
   bool isEnd  () const;
 
   void exec();
 
+  void compile(CAwkProgram &program) const;
+
   void print(std::ostream &os) const;
 
   friend std::ostream &operator<<(std::ostream &os, const CAwkPatternAction &th) {
@@ -89,21 +95,81 @@ class CAwk {
   void print(std::ostream &os) const;
 
   bool process();
+  bool processActions();
+  bool processProgram();
+
+  void compileProgram();
+
+  void initMultiMatch();
+  bool isMultiMatch(int id);
 
   void setLine(const std::string &line);
 
-  const std::string &getLine() { return line_; }
+  const std::string &getLine() const { return line_; }
 
-  const std::string &getLineField(uint pos) const;
+  std::string_view getLineField(uint pos) const;
+  void appendLineField(uint pos, std::string &str) const;
   void setLineField(uint pos, const std::string &value);
 
-  void setLineFields();
+  void setLineFields(bool full=false);
+  void getLineFields(StringVectorT &fields);
+  void joinLineFields(const StringVectorT &fields);
+
+  void addFieldRef(int pos);
+
+  int getNR() const { return nr_; }
+  void setNR(int nr) { nr_ = nr; }
+
+  int getFNR() const { return fnr_; }
+  void setFNR(int fnr) { fnr_ = fnr; }
+
+  int getNF() const;
+  void setNF(int nf);
+
+  const std::string &getFS() const { return fieldSplit_.getFS(); }
+  const CAwkFieldSplit &getFieldSplit() const { return fieldSplit_; }
+  void setFS(const std::string &fs);
+
+  const std::string &getOFS() const { return ofs_; }
+  void setOFS(const std::string &ofs) { ofs_ = ofs; }
+
+  const std::string &getORS() const { return ors_; }
+  void setORS(const std::string &ors) { ors_ = ors; }
+
+  const std::string &getRS() const { return rs_; }
+  void setRS(const std::string &rs) { rs_ = rs; }
+
+  const CAwkNumberFormat &getOFMT() const { return ofmt_; }
+  void setOFMT(const std::string &ofmt) { ofmt_.setFormat(ofmt); }
+
+  const CAwkNumberFormat &getCONVFMT() const { return convfmt_; }
+  void setCONVFMT(const std::string &convfmt) { convfmt_.setFormat(convfmt); }
 
   CAwkExecuteStack &getExecuteStack() { return executeStack_; }
 
+  CAwkRegExpCache &getRegExpCache() { return regExpCache_; }
+
+  CAwkRegExpPtr getRegExp(CAwkValuePtr value);
+
+  CAwkFormatPtr getFormat(const std::string &format);
+
   bool getDebug() const { return debug_; }
   void setDebug(bool debug=true) { debug_ = debug; }
 
+  bool getCompile() const { return compile_; }
+  void setCompile(bool compile=true) { compile_ = compile; }
+
+  bool getVM() const { return vm_; }
+  void setVM(bool vm=true) { vm_ = vm; }
+
+  bool getDFA() const { return dfa_; }
+  void setDFA(bool dfa=true) { dfa_ = dfa; }
+
+  bool hasParseFunctions() const { return parseFunctions_; }
+
+  int getExitCode() const { return exitCode_; }
+  void setExitCode(int exitCode) { exitCode_ = exitCode; }
+
   CAwkValuePtr getReturnValue() const;
   void setReturnValue(CAwkValuePtr returnValue);
 
@@ -159,10 +225,37 @@ class CAwk {
   CAwkVariablePtr getVariable(const std::string &name, bool create=false, bool global=false) const;
   CAwkVariablePtr addVariable(const std::string &name, bool global=false);
 
+  void resolveVariable(CAwkVariableRefPtr var);
+
+  CAwkVariable *getGlobalVariable(int slot) const { return variableMgr_.getVariable(slot); }
+  CAwkVariable *getLocalVariable(int slot) const { return currentBlock_->getVariable(slot); }
+
   CFile *getFile(FILE *file);
   CFile *getFile(const std::string &fileName, CFileBase::Mode mode);
   bool   closeFile(const std::string &fileName);
 
+  CAwkOutputBuffer *getOutput(FILE *file);
+  CAwkOutputBuffer *getOutput(const std::string &fileName, CFileBase::Mode mode,
+                              CAwkFileMgr::OutputFile **outputFile=nullptr);
+
+  void touchOutputFile(CAwkFileMgr::OutputFile *outputFile) {
+    fileMgr_.touchOutputFile(outputFile); }
+
+  CAwkRecordReader *getReader(const std::string &fileName);
+
+  // limit on simultaneously open output files
+  uint getMaxOpenFiles() const { return fileMgr_.getMaxOpen(); }
+  void setMaxOpenFiles(uint n) { fileMgr_.setMaxOpen(n); }
+
+  // reader for current main input file (stdin if none)
+  CAwkRecordReader *getMainReader();
+
+  bool flushFile(const std::string &fileName);
+  void flushFiles();
+
+  // changes when any file or pipe output is closed
+  uint getOutputGen() const { return fileMgr_.getGen() + pipeMgr_.getGen(); }
+
   CAwkPipe *getPipe(const std::string &cmdName, CAwkPipe::Type);
   bool      closePipe(const std::string &cmdName);
 
@@ -198,22 +291,56 @@ class CAwk {
   using ParseP = std::unique_ptr<CStrParse>;
   using FileP  = std::unique_ptr<CFile>;
 
+  // parsed printf formats by format string
+  using FormatMap = std::unordered_map<std::string, CAwkFormatPtr>;
+
+  // fields as offset/length into line
+  using LineFields = CAwkFieldSplit::Fields;
+
   ParseP                       parser_;
   CAwkFunctionMgr              functionMgr_;
   CAwkVariableMgr              variableMgr_;
   CAwkFileMgr                  fileMgr_;
   CAwkPipeMgr                  pipeMgr_;
+  CAwkRegExpCache              regExpCache_;
+  FormatMap                    formats_;
+  CAwkDFAPtr                   multiDFA_;
+  std::vector<char>            multiMatched_;
+  long                         multiGen_ { -1 };
   PatternActionList            patternActionList_;
   CAwkExecuteStack             executeStack_;
   std::string                  line_;
-  std::optional<StringVectorT> lineFields_;
-  std::string                  output_field_separator_;
-  std::string                  output_record_separator_;
+  long                         lineGen_  { 0 }; // incremented when line changes
+  LineFields                   lineFields_;                  // reused for each line
+  bool                         lineFieldsSplit_   { false }; // lineFields_ valid for line
+  bool                         lineFieldsPartial_ { false };
+  int                          maxField_  { 0 };
+  bool                         allFields_ { false };
+  int                          nr_       { 0 };
+  int                          fnr_      { 0 };
+  int                          nf_       { 0 };
+  CAwkFieldSplit               fieldSplit_;
+  std::string                  ofs_      { " " };
+  std::string                  ors_      { "\n" };
+  std::string                  rs_       { "\n" };
+  CAwkRecordReader*            mainReader_ { nullptr };
+  CAwkNumberFormat             ofmt_;
+  CAwkNumberFormat             convfmt_;
   std::string                  real_output_format_;
   FileP                        input_file_;
   std::string                  file_name_;
   int                          line_num_ { 0 };
   bool                         debug_    { false };
+  bool                         compile_  { true };
+  bool                         vm_       { true };
+  bool                         dfa_      { true };
+  bool                         parseFunctions_ { false };
+  CAwkProgramPtr               beginProgram_;
+  CAwkProgramPtr               mainProgram_;
+  CAwkProgramPtr               endProgram_;
+  bool                         exited_   { false };
+  int                          exitCode_ { 0 };
+  StringVectorT                parseArgs_;
   CAwkActionBlockPtr           currentBlock_;
   CAwkActionBlockList          blockStack_;
   CAwkValuePtr                 returnValue_;
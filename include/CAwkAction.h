@@ -1,12 +1,68 @@
 #ifndef CAWK_ACTION_H
 #define CAWK_ACTION_H
 
+#include <CAwkRecordReader.h>
 #include <CFile.h>
 
+/*
+ * User space buffer for output to stdout, stderr or a file.
+ *
+ * Output is written when the buffer is full, on flush or when destroyed. stdout is
+ * line buffered when it is a terminal and stderr is unbuffered.
+ */
+class CAwkOutputBuffer {
+ public:
+  enum class Mode {
+    FULL,
+    LINE,
+    NONE
+  };
+
+ public:
+  CAwkOutputBuffer(FILE *fp, Mode mode=Mode::FULL);
+  CAwkOutputBuffer(CFile *file);
+ ~CAwkOutputBuffer();
+
+  void write(const std::string &str);
+
+  // append directly to buffer then call endAppend to apply buffering mode
+  std::string &beginAppend() { appendPos_ = buffer_.size(); return buffer_; }
+  void endAppend();
+
+  void flush();
+
+ private:
+  static const size_t s_bufferSize = 65536;
+
+  FILE*       fp_        { nullptr };
+  CFile*      file_      { nullptr };
+  Mode        mode_      { Mode::FULL };
+  std::string buffer_;
+  size_t      appendPos_ { 0 };
+};
+
+//----
+
 /*
  * Manager for opened files include special handling for stdin. stdout and stderr
+ *
+ * Output files are indexed by name. At most maxOpen output files are open at once,
+ * the least recently used file is closed (after flushing) when another is needed
+ * and reopened for append when next written.
  */
 class CAwkFileMgr {
+ public:
+  struct OutputFile;
+
+  using LRUList = std::list<OutputFile *>; // most recently used first
+
+  struct OutputFile {
+    CFile*            file   { nullptr };
+    CAwkOutputBuffer* output { nullptr };                // null when closed
+    CFileBase::Mode   mode   { CFileBase::Mode::NONE }; // requested mode
+    LRUList::iterator lruPos;
+  };
+
  public:
   CAwkFileMgr();
  ~CAwkFileMgr() { }
@@ -14,22 +70,66 @@ class CAwkFileMgr {
   void init();
   void term();
 
+  uint getMaxOpen() const { return maxOpen_; }
+  void setMaxOpen(uint maxOpen) { maxOpen_ = (maxOpen > 0 ? maxOpen : 1); }
+
+  // incremented when an output buffer is deleted
+  uint getGen() const { return gen_; }
+
   CFile *getFile(FILE *file);
   CFile *getFile(const std::string &fileName, CFileBase::Mode mode);
 
+  CAwkOutputBuffer *getOutput(FILE *file);
+
+  // output buffer for file (optionally return file so cached outputs can be touched)
+  CAwkOutputBuffer *getOutput(const std::string &fileName, CFileBase::Mode mode,
+                              OutputFile **outputFile=nullptr);
+
+  // mark open output file as most recently used
+  void touchOutputFile(OutputFile *outputFile);
+
+  // persistent record reader for getline from file ("-" is stdin)
+  CAwkRecordReader *getReader(const std::string &fileName);
+
   bool closeFile(const std::string &fileName);
 
+  bool flushFile(const std::string &fileName);
+  void flush();
+
  private:
-  using FileList = std::list<CFile *>;
+  using OutputFileMap = std::unordered_map<std::string, OutputFile>;
+  using ReaderMap     = std::unordered_map<std::string, CAwkRecordReader *>;
 
-  FileList  files_;
-  CFile*    stdInFile_  { nullptr };
-  CFile*    stdOutFile_ { nullptr };
-  CFile*    stdErrFile_ { nullptr };
+ private:
+  OutputFile &getOutputFile(const std::string &fileName, CFileBase::Mode mode);
+
+  void openOutputFile (OutputFile &outputFile, CFileBase::Mode mode);
+  void closeOutputFile(OutputFile &outputFile);
+
+ private:
+  OutputFileMap     outputFiles_;
+  LRUList           lru_;                         // open output files
+  uint              maxOpen_    { 256 };
+  uint              gen_        { 0 };
+  ReaderMap         readers_;
+  CFile*            stdInFile_  { nullptr };
+  CFile*            stdOutFile_ { nullptr };
+  CFile*            stdErrFile_ { nullptr };
+  CAwkOutputBuffer* stdOut_     { nullptr };
+  CAwkOutputBuffer* stdErr_     { nullptr };
 };
 
 //----
 
+/*
+ * Command pipe.
+ *
+ * An output pipe starts the command on first write and streams output to it through
+ * a bounded buffer (writes block while the command catches up).
+ *
+ * An input pipe starts the command on first read and stays open so each getline
+ * reads the next record. At end of input the command is waited for.
+ */
 class CAwkPipe {
  public:
   enum class Type {
@@ -46,22 +146,29 @@ class CAwkPipe {
 
   Type getType() const { return type_; }
 
-  void addInput(const std::string &input) {
-    input_ += input;
-  }
+  // read next record from input pipe (starts command if needed)
+  bool readRecord(std::string &str);
 
-  void setOutput(std::string *output) {
-    output_ = output;
-  }
+  // buffer for output pipe (starts command if needed)
+  CAwkOutputBuffer *getOutput();
+
+  void flush();
 
   void close();
 
  private:
-  std::string  cmdName_;
-  Type         type_   { Type::NONE };
-  bool         opened_ { false };
-  std::string  input_;
-  std::string *output_ { nullptr };
+  bool open(const char *mode);
+
+  void closeFP();
+
+ private:
+  std::string       cmdName_;
+  Type              type_   { Type::NONE };
+  bool              opened_ { false };
+  FILE*             fp_     { nullptr }; // command pipe
+  CAwkOutputBuffer* buffer_ { nullptr }; // output pipe buffer
+  CAwkRecordReader* reader_ { nullptr }; // input pipe reader
+  bool              eof_    { false };   // input pipe at end
 };
 
 //----
@@ -78,10 +185,19 @@ class CAwkPipeMgr {
 
   bool closePipe(const std::string &cmdName);
 
+  bool flushPipe(const std::string &cmdName);
+  void flush();
+
+  // incremented when a pipe is deleted
+  uint getGen() const { return gen_; }
+
  private:
-  using PipeList = std::list<CAwkPipe *>;
+  using PipeList = std::list<CAwkPipe *>; // in open order
+  using PipeMap  = std::unordered_map<std::string, PipeList::iterator>;
 
   PipeList pipes_;
+  PipeMap  pipeMap_;
+  uint     gen_ { 0 };
 };
 
 //----
@@ -110,7 +226,13 @@ class CAwkIFile {
   CAwkIFile *dup() const { return nullptr; }
 
  public:
-  bool read(std::string &str) const;
+  Type getType() const { return type_; }
+
+  // read next record (1 if read, 0 at end of input, -1 if can't be opened)
+  int read(std::string &str) const;
+
+  // read record into variable (or $0 if none). returns read status
+  int getLine(CAwkVariableRefPtr var) const;
 
   void print(std::ostream &os) const;
 
@@ -119,7 +241,7 @@ class CAwkIFile {
   }
 
  private:
-  CFile *getFile() const;
+  CAwkRecordReader *getReader() const;
 };
 
 class CAwkOFile {
@@ -131,8 +253,15 @@ class CAwkOFile {
   };
 
  private:
-  CAwkExpressionPtr expression_;
-  Type              type_;
+  using OutputFile = CAwkFileMgr::OutputFile;
+
+  CAwkExpressionPtr         expression_;
+  Type                      type_;
+  bool                      isConst_    { false };   // constant destination name
+  mutable std::string       name_;                   // last destination name
+  mutable CAwkOutputBuffer* output_     { nullptr }; // last destination output
+  mutable OutputFile*       outputFile_ { nullptr }; // file of output_ (null if pipe)
+  mutable uint              outputGen_  { 0 };       // output generation of output_
 
  public:
   static CAwkOFilePtr create(CAwkExpressionPtr expression, Type type) {
@@ -140,15 +269,16 @@ class CAwkOFile {
   }
 
  private:
-  CAwkOFile(CAwkExpressionPtr expression, Type type) :
-   expression_(expression), type_(type) {
-  }
+  CAwkOFile(CAwkExpressionPtr expression, Type type);
 
   CAwkOFile *dup() const { return nullptr; }
 
  public:
   void write(const std::string &str);
 
+  // output buffer for file or pipe (null if pipe could not be started)
+  CAwkOutputBuffer *getOutput() const;
+
   void print(std::ostream &os) const;
 
   friend std::ostream &operator<<(std::ostream &os, const CAwkOFile &th) {
@@ -156,7 +286,7 @@ class CAwkOFile {
   }
 
  private:
-  CFile *getFile() const;
+  CAwkOutputBuffer *touchOutput() const;
 };
 
 //------------
@@ -172,6 +302,9 @@ class CAwkAction {
 
   virtual void exec() = 0;
 
+  // add to compiled program (default is execute action)
+  virtual void compile(CAwkProgram &program);
+
   virtual void print(std::ostream &os) const = 0;
 
   friend std::ostream &operator<<(std::ostream &os, const CAwkAction &th) {
@@ -206,6 +339,8 @@ class CAwkBreakAction : public CAwkAction {
  public:
   void exec() override;
 
+  void compile(CAwkProgram &program) override;
+
   void print(std::ostream &os) const override { os << "break" << std::endl; }
 };
 
@@ -221,6 +356,8 @@ class CAwkContinueAction : public CAwkAction {
  public:
   void exec() override;
 
+  void compile(CAwkProgram &program) override;
+
   void print(std::ostream &os) const override { os << "continue" << std::endl; }
 };
 
@@ -236,6 +373,8 @@ class CAwkNextAction : public CAwkAction {
  public:
   void exec() override;
 
+  void compile(CAwkProgram &program) override;
+
   void print(std::ostream &os) const override { os << "next" << std::endl; }
 };
 
@@ -256,6 +395,8 @@ class CAwkReturnAction : public CAwkAction {
  public:
   void exec() override;
 
+  void compile(CAwkProgram &program) override;
+
   void print(std::ostream &os) const override;
 };
 
@@ -276,6 +417,8 @@ class CAwkExitAction : public CAwkAction {
  public:
   void exec() override;
 
+  void compile(CAwkProgram &program) override;
+
   void print(std::ostream &os) const override;
 };
 
@@ -318,6 +461,8 @@ class CAwkIfAction : public CAwkAction {
  public:
   void exec() override;
 
+  void compile(CAwkProgram &program) override;
+
   void print(std::ostream &os) const override;
 };
 
@@ -340,6 +485,8 @@ class CAwkIfElseAction : public CAwkAction {
  public:
   void exec() override;
 
+  void compile(CAwkProgram &program) override;
+
   void print(std::ostream &os) const override;
 };
 
@@ -365,6 +512,8 @@ class CAwkForAction : public CAwkAction {
  public:
   void exec() override;
 
+  void compile(CAwkProgram &program) override;
+
   void print(std::ostream &os) const override;
 };
 
@@ -387,6 +536,8 @@ class CAwkForInAction : public CAwkAction {
  public:
   void exec() override;
 
+  void compile(CAwkProgram &program) override;
+
   void print(std::ostream &os) const override;
 };
 
@@ -407,6 +558,8 @@ class CAwkWhileAction : public CAwkAction {
  public:
   void exec() override;
 
+  void compile(CAwkProgram &program) override;
+
   void print(std::ostream &os) const override;
 };
 
@@ -427,6 +580,8 @@ class CAwkDoWhileAction : public CAwkAction {
  public:
   void exec() override;
 
+  void compile(CAwkProgram &program) override;
+
   void print(std::ostream &os) const override;
 };
 
@@ -447,6 +602,8 @@ class CAwkActionListAction : public CAwkAction {
  public:
   void exec() override;
 
+  void compile(CAwkProgram &program) override;
+
   void print(std::ostream &os) const override;
 };
 
@@ -490,6 +647,27 @@ class CAwkCloseAction : public CAwkAction {
   void print(std::ostream &os) const override;
 };
 
+// fflush() or fflush(<file>)
+class CAwkFFlushAction : public CAwkAction {
+ private:
+  CAwkExpressionPtr expression_;
+
+ public:
+  static CAwkActionPtr create(CAwkExpressionPtr expression) {
+    return CAwkActionPtr(new CAwkFFlushAction(expression));
+  }
+
+ private:
+  CAwkFFlushAction(CAwkExpressionPtr expression) :
+   expression_(expression) {
+  }
+
+ public:
+  void exec() override;
+
+  void print(std::ostream &os) const override;
+};
+
 class CAwkGetLineAction : public CAwkAction {
  private:
   CAwkVariableRefPtr var_;
@@ -515,6 +693,8 @@ class CAwkPrintAction : public CAwkAction {
  private:
   CAwkExpressionList expressionList_;
   CAwkOFilePtr       file_;
+  std::vector<int>   fieldPos_;             // field position of each plain $<n> expression
+  bool               fieldsOnly_ { true }; // all expressions are plain fields
 
  public:
   static CAwkActionPtr
@@ -525,18 +705,28 @@ class CAwkPrintAction : public CAwkAction {
  private:
   CAwkPrintAction(const CAwkExpressionList &expressionList, CAwkOFilePtr file) :
    expressionList_(expressionList), file_(file) {
+    for (const auto &expression : expressionList_) {
+      fieldPos_.push_back(expression->fieldPos());
+
+      if (fieldPos_.back() < 0)
+        fieldsOnly_ = false;
+    }
   }
 
  public:
   void exec() override;
 
   void print(std::ostream &os) const override;
+
+ private:
+  void appendValues(const CAwkValueList &values, std::string &str) const;
 };
 
 class CAwkPrintFAction : public CAwkAction {
  private:
   CAwkExpressionList expressionList_;
   CAwkOFilePtr       file_;
+  CAwkFormatPtr      format_; // parsed constant format
 
  public:
   static CAwkActionPtr
@@ -545,14 +735,16 @@ class CAwkPrintFAction : public CAwkAction {
   }
 
  private:
-  CAwkPrintFAction(const CAwkExpressionList &expressionList, CAwkOFilePtr file) :
-   expressionList_(expressionList), file_(file) {
-  }
+  CAwkPrintFAction(const CAwkExpressionList &expressionList, CAwkOFilePtr file);
 
  public:
   void exec() override;
 
   void print(std::ostream &os) const override;
+
+ private:
+  void appendValues(const CAwkFormat &format, const CAwkValueList &values,
+                    std::string &str) const;
 };
 
 class CAwkSystemAction : public CAwkAction {
@@ -599,6 +791,8 @@ class CAwkActionList {
 
   void exec();
 
+  void compile(CAwkProgram &program) const;
+
   void print(std::ostream &os) const;
 
   friend std::ostream &operator<<(std::ostream &os, const CAwkActionList &th) {
@@ -630,6 +824,9 @@ class CAwkActionBlock {
   CAwkVariablePtr getVariable(const std::string &name) const;
   CAwkVariablePtr addVariable(const std::string &name);
 
+  // local variable by slot (function args in order)
+  CAwkVariable *getVariable(int slot) const { return variableMgr_.getVariable(slot); }
+
   void exec();
 
   CAwkValuePtr getReturnValue() const { return returnValue_; }
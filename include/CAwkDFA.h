@@ -0,0 +1,154 @@
+#ifndef CAWK_DFA_H
+#define CAWK_DFA_H
+
+#include <bitset>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+class CAwkDFA;
+
+using CAwkDFAPtr = std::shared_ptr<CAwkDFA>;
+
+/*
+ * Lazily built DFA for POSIX extended regular expressions.
+ *
+ * The regexp is compiled to a Thompson NFA and DFA states (sets of NFA states) are
+ * created on demand as input is scanned, so matching is linear in the string length.
+ * Only answers whether the regexp matches somewhere in the string (no match range).
+ *
+ * Several regexps can be combined into one DFA so a single scan of the string returns
+ * the set of regexps which match.
+ *
+ * An anchored DFA only matches at a given start position and returns the length of the
+ * longest match there. A reverse DFA (regexp compiled right to left) scans the string
+ * backwards once to mark where matches start. Together they find separator match
+ * ranges without CRegExp or a match attempt at every position.
+ *
+ * Supports literals, escapes, '.', bracket expressions (ranges, negation and
+ * [:class:]), anchors, grouping, alternation and the *, +, ? and {n,m} repeats.
+ * compile() returns null for anything else so the caller can fall back to CRegExp.
+ */
+class CAwkDFA {
+ public:
+  static CAwkDFAPtr compile(const std::string &pattern);
+  static CAwkDFAPtr compile(const std::vector<std::string> &patterns);
+
+  static CAwkDFAPtr compileAnchored(const std::string &pattern);
+  static CAwkDFAPtr compileReverse (const std::string &pattern);
+
+ private:
+  CAwkDFA() { }
+
+  static CAwkDFAPtr compilePatterns(const std::vector<std::string> &patterns, bool reverse);
+
+ public:
+  uint numPatterns() const { return numPatterns_; }
+
+  // does regexp (any regexp if combined) match anywhere in string
+  bool find(const std::string &str) const;
+
+  // set matched flag for each combined regexp which matches anywhere in string
+  void findAll(const std::string &str, std::vector<char> &matched) const;
+
+  // length of longest match starting at pos (npos if none). anchored dfa only
+  size_t matchLength(const std::string &str, size_t pos) const;
+
+  // set starts[i] if a match starting at i consumes str[i] (or the regexp matches
+  // empty). reverse dfa only
+  void findStarts(const std::string &str, std::vector<char> &starts) const;
+
+ private:
+  enum class Type {
+    CHARS, // match one char in set
+    SPLIT, // epsilon to out and out1
+    EMPTY, // epsilon to out
+    BOL,   // epsilon to out at start of string
+    EOL,   // epsilon to out at end of string
+    MATCH  // accept
+  };
+
+  using CharSet = std::bitset<256>;
+
+  struct State {
+    Type    type { Type::EMPTY };
+    CharSet chars;
+    int     out  { -1 };
+    int     out1 { -1 };
+    int     id   { -1 }; // pattern of match state
+  };
+
+  // unconnected exit (state and out (0) or out1 (1))
+  using Exit  = std::pair<int, int>;
+  using Exits = std::vector<Exit>;
+
+  struct Frag {
+    int   start { -1 };
+    Exits exits;
+  };
+
+  using StateSet = std::vector<int>;
+  using IdList   = std::vector<int>;
+
+  struct DState {
+    StateSet states;
+    int      next[256];
+    IdList   accepts;    // matched patterns
+    IdList   acceptsEnd; // matched patterns if at end of string
+  };
+
+ private:
+  // parser
+  bool parseAlt   (Frag &frag);
+  bool parseConcat(Frag &frag);
+  bool parseRepeat(Frag &frag);
+  bool parseAtom  (Frag &frag);
+  bool parseBracket(CharSet &chars);
+  bool parseEscape(char &c);
+  bool parseInteger(int &i);
+
+  bool atEnd() const { return pos_ >= pattern_.size(); }
+
+  // nfa
+  int addState(Type type, int out=-1, int out1=-1);
+
+  Frag charsFrag(const CharSet &chars);
+  Frag emptyFrag(Type type=Type::EMPTY);
+
+  void patch(const Exits &exits, int state);
+
+  void concat(Frag &frag1, const Frag &frag2);
+
+  Frag altFrag     (const Frag &frag1, const Frag &frag2);
+  Frag starFrag    (const Frag &frag);
+  Frag questionFrag(const Frag &frag);
+
+  // dfa
+  void closure(StateSet &states, bool bol, bool eol) const;
+
+  void setAccepts(DState &dstate, const StateSet &endStates) const;
+
+  int addDState(const StateSet &states) const;
+  int nextDState(int ds, unsigned char c) const;
+
+  void resetDStates() const;
+
+ private:
+  using DStates   = std::vector<DState>;
+  using DStateMap = std::map<StateSet, int>;
+
+  std::string        pattern_;
+  size_t             pos_       { 0 };
+  uint               numPatterns_ { 0 };
+  bool               anchored_  { false };
+  bool               reverse_   { false }; // parse concatenation right to left
+  std::vector<State> states_;
+  int                start_     { -1 };
+  StateSet           startMid_;          // start closure after first char
+  mutable DStates    dstates_;
+  mutable DStateMap  dstateMap_;
+  mutable int        midDState_ { -1 }; // start state after first char
+};
+
+#endif
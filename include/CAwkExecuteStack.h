@@ -17,6 +17,8 @@ class CAwkExecuteStack {
   void addTerm(CAwkOperatorPtr op);
   void addTerm(CAwkExpressionTermPtr term);
 
+  void pushTerm(CAwkExpressionTermPtr term);
+
   bool checkUnstack(CAwkOperatorPtr op);
 
   void unstackExpression();
@@ -44,6 +46,7 @@ class CAwkExecuteStack {
 
   CAwkExecuteSubStack* executeSubStack_      { nullptr };
   ExecuteSubStackStack executeSubStackStack_;
+  ExecuteSubStackStack freeSubStacks_;
 };
 
 //----
@@ -55,12 +58,16 @@ class CAwkExecuteSubStack {
   void addTerm(CAwkOperatorPtr op);
   void addTerm(CAwkExpressionTermPtr term);
 
+  void pushTerm(CAwkExpressionTermPtr term) { termList_.push_back(term); }
+
   bool checkUnstack(CAwkOperatorPtr op);
 
   void unstackExpression();
 
   bool hasLastOp() const { return !!lastOp_; }
 
+  void reset();
+
   CAwkVariableRefPtr popVariableRef();
 
   CAwkValuePtr popValue();
@@ -29,7 +29,33 @@ class CAwkExpressionTerm {
 
 //---
 
+/*
+ * Expression as parsed (flat infix list of terms).
+ *
+ * The term list is compiled into a linear postfix code list with operator precedence
+ * already resolved and jumps for the short circuit operators (&&, || and ?:) so the
+ * execute stack does not need to re-resolve precedence on every evaluation.
+ */
 class CAwkExpression : public CAwkExpressionTerm {
+ public:
+  enum class OpCode {
+    PUSH,       // push term
+    CALL,       // call function and push result
+    OPERATOR,   // execute operator on stacked terms and push result
+    AND,        // pop lhs of && and jump (with false result) if false
+    OR,         // pop lhs of || and jump (with true result) if true
+    BOOL,       // convert top term to boolean value
+    JUMP_FALSE, // pop condition of ?: and jump if false
+    JUMP        // unconditional jump
+  };
+
+  struct Inst {
+    OpCode                code { OpCode::PUSH };
+    CAwkExpressionTermPtr term;
+    CAwkOperatorPtr       op;
+    int                   jump { -1 };
+  };
+
  protected:
   CAwkExpression();
 
@@ -52,22 +78,43 @@ class CAwkExpression : public CAwkExpressionTerm {
 
   uint numTerms() const { return uint(termList_.size()); }
 
+  int maxFieldPos() const;
+
+  // field position if expression is just $<n> (-1 otherwise)
+  int fieldPos() const;
+
+  // value if expression is just a constant (null otherwise)
+  CAwkValuePtr constValue() const;
+
+  bool isCompiled() const { return compiled_; }
+
+  void compile();
+
   CAwkExpressionTermPtr execute() override;
 
   void print(std::ostream &os) const override;
 
+  void printCode(std::ostream &os) const;
+
   friend std::ostream &operator<<(std::ostream &os, const CAwkExpression &th) {
     th.print(os); return os;
   }
 
+ private:
+  CAwkExpressionTermPtr executeTerms();
+  CAwkExpressionTermPtr executeCode();
+
  private:
   using TermList = CAwkExpressionTermList;
   using OpStack  = CAwkOperatorList;
+  using Code     = std::vector<Inst>;
 
   TermList        termList_;
   bool            value_ { false };
   OpStack         opStack_;
   CAwkOperatorPtr lastOp_;
+  Code            code_;
+  bool            compiled_ { false };
 };
 
 //---
@@ -0,0 +1,77 @@
+#ifndef CAWK_FIELD_SPLIT_H
+#define CAWK_FIELD_SPLIT_H
+
+#include <CAwkTypes.h>
+#include <string>
+#include <vector>
+#include <cstddef>
+
+/*
+ * Field splitter for a field separator (FS or split() separator).
+ *
+ * Follows POSIX rules: " " splits on runs of blanks (ignoring leading and trailing
+ * blanks), any other single char splits on each occurrence (keeping empty fields)
+ * and longer separators are extended regular expressions taken from the regexp cache
+ * (so each is compiled once) when the separator is set. A regexp literal separator
+ * (split(s, a, /re/)) is always a regular expression.
+ *
+ * The blank and single char searches use AVX2 or SSE2 byte compares when the CPU
+ * supports them (selected at runtime) with a scalar fallback.
+ */
+class CAwkFieldSplit {
+ public:
+  // field as offset/length into split string
+  struct Field {
+    size_t pos { 0 };
+    size_t len { 0 };
+
+    Field(size_t pos, size_t len) :
+     pos(pos), len(len) {
+    }
+  };
+
+  using Fields = std::vector<Field>;
+
+ public:
+  CAwkFieldSplit(const std::string &fs=" ");
+
+  const std::string &getFS() const { return fs_; }
+  void setFS(const std::string &fs);
+
+  // regexp separator (null if blank or single char separator)
+  const CAwkRegExpPtr &getRegExp() const { return regexp_; }
+  void setRegExp(const CAwkRegExpPtr &regexp);
+
+  // split string into fields (at most maxFields if non-zero).
+  // returns true if split stopped with fields remaining
+  bool split(const std::string &str, Fields &fields, uint maxFields=0) const;
+
+  //---
+
+  // index of first blank at or after pos (len if none)
+  static size_t findSpace(const char *str, size_t len, size_t pos);
+
+  // index of first non blank at or after pos (len if none)
+  static size_t skipSpace(const char *str, size_t len, size_t pos);
+
+  // index of first c at or after pos (len if none)
+  static size_t findChar(const char *str, size_t len, size_t pos, char c);
+
+ private:
+  bool splitRegExp(const std::string &str, Fields &fields, uint maxFields) const;
+
+ private:
+  enum class Type {
+    SPACE,
+    CHAR,
+    REGEXP
+  };
+
+  std::string   fs_;
+  Type          type_ { Type::SPACE };
+  char          c_    { ' ' };
+  CAwkRegExpPtr regexp_;
+  mutable std::vector<char> starts_; // separator match starts of split string
+};
+
+#endif
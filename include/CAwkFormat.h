@@ -0,0 +1,66 @@
+#ifndef CAWK_FORMAT_H
+#define CAWK_FORMAT_H
+
+#include <CAwkTypes.h>
+#include <functional>
+
+/*
+ * printf/sprintf format string parsed into literal text and conversion specs.
+ *
+ * A format is parsed once (when constant at parse time, otherwise on first use via
+ * the format cache) so formatting only needs to run the conversions.
+ */
+class CAwkFormat {
+ public:
+  // get next argument value (null if none left)
+  using ValueProc = std::function<CAwkValuePtr ()>;
+
+ public:
+  static CAwkFormatPtr create(const std::string &format) {
+    return CAwkFormatPtr(new CAwkFormat(format));
+  }
+
+ private:
+  CAwkFormat(const std::string &format);
+
+ public:
+  const std::string &getFormat() const { return format_; }
+
+  // append formatted arguments to string
+  void format(std::string &str, const ValueProc &valueProc) const;
+
+ private:
+  enum class Type {
+    LITERAL, // literal text
+    INTEGER, // d, i
+    UNSIGNED,// o, u, x, X
+    REAL,    // e, E, f, F, g, G
+    CHAR,    // c
+    STRING   // s
+  };
+
+  struct Part {
+    Type        type      { Type::LITERAL };
+    std::string text;                  // literal text or snprintf format
+    bool        starWidth { false };   // width from argument
+    bool        starPrec  { false };   // precision from argument
+    std::string flags;                 // flags (for '*' width/precision)
+    std::string width;
+    std::string prec;                  // precision (including '.')
+    char        conv      { '\0' };    // conversion char
+  };
+
+  using Parts = std::vector<Part>;
+
+ private:
+  void addLiteral(const std::string &text);
+
+  static void appendChar  (std::string &str, const char *fmt, char c);
+  static void appendPrintf(std::string &str, const char *fmt, ...);
+
+ private:
+  std::string format_;
+  Parts       parts_;
+};
+
+#endif
@@ -2,6 +2,7 @@
 #define CAWK_FUNCTION_H
 
 #include <CAwkTypes.h>
+#include <CAwkFieldSplit.h>
 
 class CAwkFunction {
  protected:
@@ -87,6 +88,7 @@ class CAwkParseFunction : public CAwkFunction {
  private:
   StringVectorT     args_;
   CAwkActionListPtr actionList_;
+  CAwkProgramPtr    program_;
 };
 
 //----
@@ -362,6 +364,10 @@ class CAwkSplitFunction : public CAwkBuiltinFunction {
   CAwkValuePtr exec(const CAwkExpressionTermList &values) override;
 
   void print(std::ostream &os) const override;
+
+ private:
+  CAwkFieldSplit fieldSplit_;              // last separator argument
+  bool           regexpLiteral_ { false }; // separator set from regexp literal
 };
 
 //----
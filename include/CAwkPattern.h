@@ -1,7 +1,7 @@
 #ifndef CAWK_PATTERN_H
 #define CAWK_PATTERN_H
 
-#include <CRegExp.h>
+#include <CAwkRegExp.h>
 
 class CAwkPattern {
  protected:
@@ -49,16 +49,21 @@ class CAwkRegExpPattern : public CAwkPattern {
  private:
   CAwkRegExpPattern(const std::string &regexp) :
    regexp_(regexp) {
-    regexp_.setExtended(true);
   }
 
  public:
+  const CAwkRegExp &getRegExp() const { return regexp_; }
+
+  // index in combined rule regexps (-1 if not combined)
+  void setMultiId(int id) { multiId_ = id; }
+
   bool exec() override;
 
   void print(std::ostream &os) const override;
 
  private:
-  CRegExp regexp_;
+  CAwkRegExp regexp_;
+  int        multiId_ { -1 };
 };
 
 //---
@@ -0,0 +1,110 @@
+#ifndef CAWK_PROGRAM_H
+#define CAWK_PROGRAM_H
+
+/*
+ * Compiled program code (BEGIN, main, END or function body).
+ *
+ * Actions are compiled into a linear instruction list with control flow (if, loops,
+ * break, continue, next, exit and return) resolved to jumps, so the dispatch loop
+ * does not need to poll the block flags between statements. Simple statements are
+ * still executed by the action itself.
+ */
+class CAwkProgram {
+ public:
+  enum class OpCode {
+    HALT,        // stop execution
+    EXEC,        // execute simple action
+    EVAL,        // evaluate expression (result ignored)
+    JUMP,        // unconditional jump
+    JUMP_FALSE,  // evaluate expression and jump if false
+    JUMP_TRUE,   // evaluate expression and jump if true
+    MATCH,       // evaluate pattern and jump if no match
+    FOR_IN_INIT, // store array indices in register
+    FOR_IN_NEXT, // assign next register index to variable or jump if done
+    NEXT,        // stop processing current record
+    EXIT,        // stop processing input
+    RETURN       // return from function
+  };
+
+  enum class Status {
+    NONE,
+    NEXT,
+    EXIT,
+    RETURN
+  };
+
+  struct Inst {
+    OpCode           code    { OpCode::HALT };
+    CAwkAction*      action  { nullptr };
+    CAwkExpression*  expr    { nullptr };
+    CAwkPattern*     pattern { nullptr };
+    CAwkVariableRef* var     { nullptr };
+    int              jump    { -1 };
+    int              reg     { -1 };
+  };
+
+ public:
+  static CAwkProgramPtr create() {
+    return CAwkProgramPtr(new CAwkProgram);
+  }
+
+ private:
+  CAwkProgram() { }
+
+  CAwkProgram *dup() const { return nullptr; }
+
+ public:
+  void finish();
+
+  int pos() const { return int(code_.size()); }
+
+  void addExec(CAwkAction *action);
+  void addEval(CAwkExpression *expr);
+
+  int addJump();
+  int addJumpFalse(CAwkExpression *expr);
+  int addJumpTrue(CAwkExpression *expr);
+  int addMatch(CAwkPattern *pattern);
+
+  void setJump(int inst, int pos);
+
+  int addForInInit(CAwkVariableRef *var);
+  int addForInNext(int reg, CAwkVariableRef *var);
+
+  void addNext();
+  void addExit(CAwkExpression *expr);
+  void addReturn(CAwkExpression *expr);
+
+  void startLoop();
+  void endLoop(int continuePos, int breakPos);
+
+  void addBreak();
+  void addContinue();
+
+  Status exec() const;
+
+  void print(std::ostream &os) const;
+
+  friend std::ostream &operator<<(std::ostream &os, const CAwkProgram &th) {
+    th.print(os); return os;
+  }
+
+ private:
+  int addInst(const Inst &inst);
+
+ private:
+  struct Loop {
+    std::vector<int> breaks;
+    std::vector<int> continues;
+  };
+
+  using Code  = std::vector<Inst>;
+  using Loops = std::vector<Loop>;
+
+  Code  code_;
+  int   numRegs_    { 0 };
+  bool  checkFlags_ { false };
+  Loops loops_;
+};
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef CAWK_RECORD_READER_H
+#define CAWK_RECORD_READER_H
+
+#include <CRegExp.h>
+#include <string>
+
+/*
+ * Buffered reader of records from a file descriptor.
+ *
+ * Input is read in large blocks as records are requested so memory use does not
+ * depend on the input size and a command writing to a pipe can run ahead of us.
+ *
+ * Records are separated using RS rules: a single char separates records, "" is
+ * paragraph mode (records separated by blank lines) and a longer separator is an
+ * extended regular expression.
+ */
+class CAwkRecordReader {
+ public:
+  CAwkRecordReader(int fd, bool owner=false);
+ ~CAwkRecordReader();
+
+  int fd() const { return fd_; }
+
+  const std::string &getRS() const { return rs_; }
+  void setRS(const std::string &rs);
+
+  // read next record (without separator). false at end of input
+  bool readRecord(std::string &str);
+
+ private:
+  bool readChar     (std::string &str);
+  bool readParagraph(std::string &str);
+  bool readRegExp   (std::string &str);
+
+  bool readRest(std::string &str);
+
+  bool fill();
+
+ private:
+  enum class Type {
+    CHAR,
+    PARAGRAPH,
+    REGEXP
+  };
+
+  static const size_t s_blockSize = 65536;
+
+  int         fd_    { -1 };
+  bool        owner_ { false };     // close fd when done
+  std::string rs_;
+  Type        type_  { Type::CHAR };
+  char        c_     { '\n' };
+  CRegExp     regexp_;
+  std::string data_;                // buffered input
+  size_t      pos_   { 0 };         // start of next record in data
+  bool        eof_   { false };
+};
+
+#endif
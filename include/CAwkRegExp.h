@@ -0,0 +1,101 @@
+#ifndef CAWK_REGEXP_H
+#define CAWK_REGEXP_H
+
+#include <CAwkDFA.h>
+#include <CRegExp.h>
+
+/*
+ * Compiled regular expression.
+ *
+ * Match tests (patterns, ~ and !~) first check for a literal string which any match
+ * must contain and then use a lazy DFA when the program allows it and the regexp only
+ * uses supported ERE features, otherwise CRegExp. Match ranges (match, sub and gsub)
+ * always use CRegExp. Separator matches (regexp FS) use a reverse DFA to mark match
+ * starts and an anchored DFA for the match length (whatever the DFA setting) so a
+ * record is scanned once rather than from every position.
+ */
+class CAwkRegExp {
+ public:
+  CAwkRegExp(const std::string &pattern, bool extended=true);
+
+  const std::string &getPattern() const { return regexp_.getPattern(); }
+
+  const CRegExp &getRegExp() const { return regexp_; }
+
+  bool hasDFA() const { return bool(dfa_); }
+
+  const std::string &getLiteral() const { return literal_; }
+
+  // does regexp match anywhere in string
+  bool isMatch(const std::string &str) const;
+
+  // find match in string and get matched range (inclusive)
+  bool find(const std::string &str) const { return regexp_.find(str); }
+
+  bool getMatchRange(int *start, int *end) const { return regexp_.getMatchRange(start, end); }
+
+  using Starts = std::vector<char>;
+
+  // mark possible separator match starts in string (one backwards scan).
+  // returns false if regexp is not supported by the dfa
+  bool findSeparatorStarts(const std::string &str, Starts &starts) const;
+
+  // find leftmost longest non-empty match at or after pos (match is [start, end)).
+  // starts is from findSeparatorStarts for the same string (or empty if it failed)
+  bool findSeparator(const std::string &str, size_t pos, const Starts &starts,
+                     size_t &start, size_t &end) const;
+
+  static std::string requiredLiteral(const std::string &pattern);
+
+ private:
+  CRegExp     regexp_;
+  CAwkDFAPtr  dfa_;
+  mutable CAwkDFAPtr anchoredDFA_;         // compiled on first separator search
+  mutable CAwkDFAPtr reverseDFA_;
+  mutable bool       separatorInit_ { false };
+  mutable std::string separatorStr_;       // remaining string for CRegExp search
+  std::string literal_; // literal contained in all matches (empty if none)
+};
+
+//---
+
+/*
+ * LRU cache of compiled regular expressions for dynamic (string) regexps used by
+ * ~, !~, match, sub and gsub so a pattern is compiled once rather than per call.
+ */
+class CAwkRegExpCache {
+ public:
+  CAwkRegExpCache(uint maxSize=64) :
+   maxSize_(maxSize) {
+  }
+
+  // get compiled regexp for pattern (compiled and added on miss)
+  CAwkRegExpPtr get(const std::string &pattern, bool extended=true);
+
+  uint getMaxSize() const { return maxSize_; }
+  void setMaxSize(uint maxSize);
+
+  uint size() const { return uint(list_.size()); }
+
+  long getHits  () const { return hits_  ; }
+  long getMisses() const { return misses_; }
+
+  void clear();
+
+ private:
+  struct Entry {
+    std::string key;
+    CAwkRegExpPtr regexp;
+  };
+
+  using EntryList = std::list<Entry>;
+  using EntryMap  = std::unordered_map<std::string, EntryList::iterator>;
+
+  uint      maxSize_ { 64 };
+  EntryList list_; // most recently used first
+  EntryMap  map_;
+  long      hits_    { 0 };
+  long      misses_  { 0 };
+};
+
+#endif
@@ -2,9 +2,11 @@
 #define CAWK_TYPES_H
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <list>
 #include <map>
+#include <unordered_map>
 #include <memory>
 #include <iostream>
 #include <cassert>
@@ -24,10 +26,14 @@ class CAwkOperator;
 class CAwkOFile;
 class CAwkPattern;
 class CAwkPatternAction;
+class CAwkProgram;
 class CAwkValue;
 class CAwkVariable;
 class CAwkVariableRef;
 
+class CAwkFormat;
+class CAwkRegExp;
+
 using CAwkActionPtr         = std::shared_ptr<CAwkAction>;
 using CAwkActionListPtr     = std::shared_ptr<CAwkActionList>;
 using CAwkActionBlockPtr    = std::shared_ptr<CAwkActionBlock>;
@@ -40,13 +46,18 @@ using CAwkOperatorPtr       = std::shared_ptr<CAwkOperator>;
 using CAwkOFilePtr          = std::shared_ptr<CAwkOFile>;
 using CAwkPatternActionPtr  = std::shared_ptr<CAwkPatternAction>;
 using CAwkPatternPtr        = std::shared_ptr<CAwkPattern>;
+using CAwkProgramPtr        = std::shared_ptr<CAwkProgram>;
 using CAwkValuePtr          = std::shared_ptr<CAwkValue>;
 using CAwkVariablePtr       = std::shared_ptr<CAwkVariable>;
 using CAwkVariableRefPtr    = std::shared_ptr<CAwkVariableRef>;
 
+using CAwkFormatPtr = std::shared_ptr<CAwkFormat>;
+using CAwkRegExpPtr = std::shared_ptr<CAwkRegExp>;
+
 using CAwkActionBlockList    = std::vector<CAwkActionBlockPtr>;
 using CAwkExpressionTermList = std::vector<CAwkExpressionTermPtr>;
 using CAwkOperatorList       = std::vector<CAwkOperatorPtr>;
 using CAwkExpressionList     = std::vector<CAwkExpressionPtr>;
+using CAwkValueList          = std::vector<CAwkValuePtr>;
 
 #endif
@@ -3,7 +3,23 @@
 
 #include <CAwkTypes.h>
 
+/*
+ * Value with lazily converted string and numeric forms.
+ *
+ * A string value is classified as numeric on first numeric access (caching the numeric
+ * form). Only input strings (fields, getline and split() values) which look numeric
+ * become a STRNUM and compare as numbers; string constants and results stay STRING.
+ * A numeric value is only formatted (using CONVFMT, or OFMT when printed) when its
+ * string form is needed.
+ */
 class CAwkValue : public CAwkExpressionTerm {
+ public:
+  enum class Type {
+    STRING, // string (numeric form not yet known or not numeric)
+    NUMBER, // number (string form formatted on demand)
+    STRNUM  // input string which looks numeric (both forms valid)
+  };
+
  public:
   static CAwkValuePtr create(const std::string &value);
   static CAwkValuePtr create(const char *value);
@@ -11,6 +27,9 @@ class CAwkValue : public CAwkExpressionTerm {
   static CAwkValuePtr create(int value);
   static CAwkValuePtr create(bool value);
 
+  // input string (STRNUM if it looks numeric)
+  static CAwkValuePtr createStrNum(std::string_view value);
+
  protected:
   explicit CAwkValue(const std::string &value);
   explicit CAwkValue(const char *value);
@@ -18,6 +37,8 @@ class CAwkValue : public CAwkExpressionTerm {
   explicit CAwkValue(int value);
   explicit CAwkValue(bool value);
 
+  CAwkValue(std::string_view value, bool strNum);
+
  public:
   virtual ~CAwkValue() { }
 
@@ -27,14 +48,19 @@ class CAwkValue : public CAwkExpressionTerm {
 
   CAwkValuePtr getValue() const override { assert(false); }
 
+  Type getType() const;
+
   bool isReal   () const;
   bool isInteger() const;
   bool isBool   () const;
 
-  std::string getString () const;
-  double      getReal   () const;
-  int         getInteger() const;
-  bool        getBool   () const;
+  const std::string &getString () const;
+
+  // append string form to string (without creating temporary string)
+  void appendString(std::string &str) const;
+  double             getReal   () const;
+  int                getInteger() const;
+  bool               getBool   () const;
 
   void setValue  (CAwkValuePtr value);
   void setString (const std::string &value);
@@ -66,7 +92,21 @@ class CAwkValue : public CAwkExpressionTerm {
   }
 
  protected:
-  std::string value_;
+  void classify() const;
+  void format() const;
+
+  void setNumber(double value);
+
+ protected:
+  mutable Type        type_       { Type::STRING };
+  mutable std::string str_;
+  bool                strNum_     { false }; // input string (STRNUM if numeric)
+  mutable double      real_       { 0.0 };
+  mutable bool        strValid_   { true };  // string form up to date
+  mutable bool        classified_ { false }; // string checked for number
+  mutable bool        isReal_     { false };
+  mutable bool        isInteger_  { false };
+  mutable uint        fmtId_      { 0 };     // CONVFMT of string form (0 if integer)
 };
 
 //----
@@ -88,4 +128,57 @@ class CAwkNullValue : public CAwkValue {
   }
 };
 
+//----
+
+/*
+ * Regular expression literal (/re/) in an expression.
+ *
+ * String value is the regexp text. The regexp is compiled when the literal is
+ * parsed and used directly by ~, !~, match, sub and gsub.
+ */
+class CAwkRegExpValue : public CAwkValue {
+ public:
+  static CAwkValuePtr create(const std::string &regexp) {
+    return CAwkValuePtr(new CAwkRegExpValue(regexp));
+  }
+
+ private:
+  CAwkRegExpValue(const std::string &regexp);
+
+ public:
+  const CAwkRegExpPtr &getRegExp() const { return regexp_; }
+
+  void print(std::ostream &os) const override;
+
+ private:
+  CAwkRegExpPtr regexp_;
+};
+
+//----
+
+/*
+ * Number to string format (OFMT, CONVFMT).
+ *
+ * Integral values are output as integers. The common %.<n>g formats use to_chars
+ * (same output as printf) so only other formats need snprintf.
+ */
+class CAwkNumberFormat {
+ public:
+  CAwkNumberFormat(const std::string &format="%.6g") { setFormat(format); }
+
+  const std::string &getFormat() const { return format_; }
+  void setFormat(const std::string &format);
+
+  // unique id of format (changes when format set)
+  uint getId() const { return id_; }
+
+  // append formatted number to string
+  void append(std::string &str, double r) const;
+
+ private:
+  std::string format_;
+  uint        id_   { 0 };
+  int         prec_ { -1 }; // precision of %.<n>g format (-1 for other formats)
+};
+
 #endif
@@ -3,21 +3,32 @@
 
 #include <CAwkTypes.h>
 
+/*
+ * Variables stored in slots (fixed index for life of manager) with name to slot map
+ */
 class CAwkVariableMgr {
  public:
   CAwkVariableMgr() { }
 
-  void addVariable(const std::string &name, const std::string &value);
-  void addVariable(CAwkVariablePtr var);
+  int addVariable(const std::string &name, const std::string &value);
+  int addVariable(CAwkVariablePtr var);
 
   CAwkVariablePtr getVariable(const std::string &name) const;
 
+  int getSlot(const std::string &name) const;
+
+  CAwkVariable *getVariable(int slot) const { return variables_[slot].get(); }
+
+  int numVariables() const { return int(variables_.size()); }
+
   void print(std::ostream &os) const;
 
  private:
-  using VariableMap = std::map<std::string,CAwkVariablePtr>;
+  using SlotMap   = std::map<std::string,int>;
+  using Variables = std::vector<CAwkVariablePtr>;
 
-  VariableMap variableMap_;
+  SlotMap   slotMap_;
+  Variables variables_;
 };
 
 //----
@@ -44,7 +55,8 @@ class CAwkVariable {
 
   const std::string &getName() const { return name_; }
 
-  CAwkValuePtr getValue() const;
+  // overridden by special variables stored as typed fields in CAwk
+  virtual CAwkValuePtr getValue() const;
   virtual void setValue(CAwkValuePtr value);
 
   CAwkValuePtr getIndValue(const std::string &ind) const;
@@ -92,6 +104,23 @@ class CAwkARGVVariable {
 
 //----
 
+class CAwkCONVFMTVariable : public CAwkVariable {
+ public:
+  static CAwkVariablePtr create() {
+    return CAwkVariablePtr(new CAwkCONVFMTVariable);
+  }
+
+ private:
+  CAwkCONVFMTVariable() :
+   CAwkVariable("CONVFMT", "%.6g") {
+  }
+
+ public:
+  void setValue(CAwkValuePtr value) override;
+};
+
+//----
+
 class CAwkFILENAMEVariable {
  public:
   static CAwkVariablePtr create() {
@@ -101,65 +130,127 @@ class CAwkFILENAMEVariable {
 
 //----
 
-class CAwkFNRVariable {
+class CAwkFNRVariable : public CAwkVariable {
  public:
   static CAwkVariablePtr create() {
-    return CAwkVariable::create("FNR", 0);
+    return CAwkVariablePtr(new CAwkFNRVariable);
   }
+
+ private:
+  CAwkFNRVariable() :
+   CAwkVariable("FNR", 0) {
+  }
+
+ public:
+  CAwkValuePtr getValue() const override;
+
+  void setValue(CAwkValuePtr value) override;
 };
 
 //----
 
-class CAwkFSVariable {
+class CAwkFSVariable : public CAwkVariable {
  public:
   static CAwkVariablePtr create() {
-    return CAwkVariable::create("FS", " ");
+    return CAwkVariablePtr(new CAwkFSVariable);
+  }
+
+ private:
+  CAwkFSVariable() :
+   CAwkVariable("FS", " ") {
   }
+
+ public:
+  void setValue(CAwkValuePtr value) override;
 };
 
 //----
 
-class CAwkNFVariable {
+class CAwkNFVariable : public CAwkVariable {
  public:
   static CAwkVariablePtr create() {
-    return CAwkVariable::create("NF", 0);
+    return CAwkVariablePtr(new CAwkNFVariable);
   }
+
+ private:
+  CAwkNFVariable() :
+   CAwkVariable("NF", 0) {
+  }
+
+ public:
+  CAwkValuePtr getValue() const override;
+
+  void setValue(CAwkValuePtr value) override;
 };
 
 //----
 
-class CAwkNRVariable {
+class CAwkNRVariable : public CAwkVariable {
  public:
   static CAwkVariablePtr create() {
-    return CAwkVariable::create("NR", 0);
+    return CAwkVariablePtr(new CAwkNRVariable);
   }
+
+ private:
+  CAwkNRVariable() :
+   CAwkVariable("NR", 0) {
+  }
+
+ public:
+  CAwkValuePtr getValue() const override;
+
+  void setValue(CAwkValuePtr value) override;
 };
 
 //----
 
-class CAwkOFMTVariable {
+class CAwkOFMTVariable : public CAwkVariable {
  public:
   static CAwkVariablePtr create() {
-    return CAwkVariable::create("OFMT", "%.6g");
+    return CAwkVariablePtr(new CAwkOFMTVariable);
   }
+
+ private:
+  CAwkOFMTVariable() :
+   CAwkVariable("OFMT", "%.6g") {
+  }
+
+ public:
+  void setValue(CAwkValuePtr value) override;
 };
 
 //----
 
-class CAwkOFSVariable {
+class CAwkOFSVariable : public CAwkVariable {
  public:
   static CAwkVariablePtr create() {
-    return CAwkVariable::create("OFS", " ");
+    return CAwkVariablePtr(new CAwkOFSVariable);
+  }
+
+ private:
+  CAwkOFSVariable() :
+   CAwkVariable("OFS", " ") {
   }
+
+ public:
+  void setValue(CAwkValuePtr value) override;
 };
 
 //----
 
-class CAwkORSVariable {
+class CAwkORSVariable : public CAwkVariable {
  public:
   static CAwkVariablePtr create() {
-    return CAwkVariable::create("ORS", "\n");
+    return CAwkVariablePtr(new CAwkORSVariable);
   }
+
+ private:
+  CAwkORSVariable() :
+   CAwkVariable("ORS", "\n") {
+  }
+
+ public:
+  void setValue(CAwkValuePtr value) override;
 };
 
 //----
@@ -173,11 +264,19 @@ class CAwkRLENGTHVariable {
 
 //----
 
-class CAwkRSVariable {
+class CAwkRSVariable : public CAwkVariable {
  public:
   static CAwkVariablePtr create() {
-    return CAwkVariable::create("RS", "\n");
+    return CAwkVariablePtr(new CAwkRSVariable);
+  }
+
+ private:
+  CAwkRSVariable() :
+   CAwkVariable("RS", "\n") {
   }
+
+ public:
+  void setValue(CAwkValuePtr value) override;
 };
 
 //----
@@ -203,6 +302,14 @@ class CAwkSUBSEPVariable {
 #include <CAwkExpression.h>
 
 class CAwkVariableRef : public CAwkExpressionTerm {
+ public:
+  // resolved location of variable (NONE is lookup by name)
+  enum class Scope {
+    NONE,
+    GLOBAL,
+    LOCAL
+  };
+
  public:
   static CAwkVariableRefPtr create(const std::string &name) {
     return CAwkVariableRefPtr(new CAwkVariableRef(name));
@@ -218,6 +325,12 @@ class CAwkVariableRef : public CAwkExpressionTerm {
  public:
   virtual ~CAwkVariableRef();
 
+  const std::string &getName() const { return name_; }
+
+  Scope getScope() const { return scope_; }
+
+  void setScope(Scope scope, int slot) { scope_ = scope; slot_ = slot; }
+
   bool hasValue() const override { return true; }
 
   void instantiate(bool global=false);
@@ -239,8 +352,13 @@ class CAwkVariableRef : public CAwkExpressionTerm {
 
   CAwkExpressionTermPtr execute() override;
 
+ private:
+  CAwkVariable *getVariable() const;
+
  private:
   std::string name_;
+  Scope       scope_ { Scope::NONE };
+  int         slot_  { -1 };
 };
 
 //---
@@ -287,6 +405,8 @@ class CAwkFieldVariableRef : public CAwkVariableRef {
   }
 
  public:
+  int getPos() const { return pos_; }
+
   CAwkValuePtr getValue() const override;
 
   void setValue(CAwkValuePtr value) override;
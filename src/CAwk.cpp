@@ -3,8 +3,10 @@
 #include <CStrUtil.h>
 #include <CFuncs.h>
 #include <CFile.h>
+#include <algorithm>
 #include <cstdio>
 #include <cstring>
+#include <fcntl.h>
 
 CAwk *
 CAwk::
@@ -36,7 +38,7 @@ init(const StringVectorT &args)
   getVariable("ARGC")->setValue(CAwkValue::create(int(argc)));
 
   for (uint i = 0; i < argc; ++i)
-    getVariable("ARGV")->setIndValue(CStrUtil::toString(i), CAwkValue::create(args[i]));
+    getVariable("ARGV")->setIndValue(CStrUtil::toString(i), CAwkValue::createStrNum(args[i]));
 }
 
 bool
@@ -108,6 +110,7 @@ addStdVariables()
 {
   variableMgr_.addVariable(CAwkARGCVariable    ::create());
   variableMgr_.addVariable(CAwkARGVVariable    ::create());
+  variableMgr_.addVariable(CAwkCONVFMTVariable ::create());
   variableMgr_.addVariable(CAwkFILENAMEVariable::create());
   variableMgr_.addVariable(CAwkFNRVariable     ::create());
   variableMgr_.addVariable(CAwkFSVariable      ::create());
@@ -158,6 +161,8 @@ parseProgram()
       return false;
 
     addFunction(function);
+
+    parseFunctions_ = true;
   }
   else {
     CAwkPatternPtr pattern;
@@ -204,6 +209,22 @@ process()
   fileMgr_.init();
   pipeMgr_.init();
 
+  initMultiMatch();
+
+  bool rc = (getVM() ? processProgram() : processActions());
+
+  // cleanup
+  fileMgr_.term();
+  pipeMgr_.term();
+
+  return rc;
+}
+
+// process by executing pattern action list
+bool
+CAwk::
+processActions()
+{
   uint num_begin = 0;
   uint num_body  = 0;
   uint num_end   = 0;
@@ -259,37 +280,176 @@ process()
     }
   }
 
-  // cleanup
-  fileMgr_.term();
-  pipeMgr_.term();
+  return true;
+}
+
+// process by executing compiled BEGIN, main and END programs
+bool
+CAwk::
+processProgram()
+{
+  compileProgram();
+
+  exited_ = (beginProgram_->exec() == CAwkProgram::Status::EXIT);
+
+  if (! exited_ && (mainProgram_->pos() > 1 || endProgram_->pos() > 1)) {
+    StringVectorT indices = getVariable("ARGV")->getIndices();
+
+    if (indices.size() > 1) {
+      auto p1 = indices.begin();
+      auto p2 = indices.end  ();
+
+      ++p1;
+
+      for ( ; ! exited_ && p1 != p2; ++p1) {
+        std::string fileName = getVariable("ARGV")->getIndValue(*p1)->getString();
+
+        (void) execFile(fileName);
+      }
+    }
+    else
+      (void) execFile("-");
+  }
+
+  // END is run even after exit (exit in END stops it)
+  (void) endProgram_->exec();
 
   return true;
 }
 
+void
+CAwk::
+compileProgram()
+{
+  beginProgram_ = CAwkProgram::create();
+  mainProgram_  = CAwkProgram::create();
+  endProgram_   = CAwkProgram::create();
+
+  for (const auto &patternAction : patternActionList_) {
+    if      (patternAction->isBegin())
+      patternAction->compile(*beginProgram_);
+    else if (patternAction->isEnd())
+      patternAction->compile(*endProgram_);
+    else
+      patternAction->compile(*mainProgram_);
+  }
+
+  beginProgram_->finish();
+  mainProgram_ ->finish();
+  endProgram_  ->finish();
+
+  if (getDebug()) {
+    std::cerr << "BEGIN" << std::endl << *beginProgram_;
+    std::cerr << "MAIN"  << std::endl << *mainProgram_;
+    std::cerr << "END"   << std::endl << *endProgram_;
+  }
+}
+
+// combine regexps of main rules with regexp patterns into one dfa so each record
+// is scanned once for all of them. rules are still run in order
+void
+CAwk::
+initMultiMatch()
+{
+  multiDFA_.reset();
+
+  if (! getDFA())
+    return;
+
+  std::vector<CAwkRegExpPattern *> patterns;
+  std::vector<std::string>         regexps;
+
+  for (const auto &patternAction : patternActionList_) {
+    if (patternAction->isBegin() || patternAction->isEnd())
+      continue;
+
+    auto *pattern = dynamic_cast<CAwkRegExpPattern *>(patternAction->getPattern().get());
+
+    if (! pattern || ! pattern->getRegExp().hasDFA())
+      continue;
+
+    patterns.push_back(pattern);
+    regexps .push_back(pattern->getRegExp().getPattern());
+  }
+
+  if (patterns.size() < 2)
+    return;
+
+  multiDFA_ = CAwkDFA::compile(regexps);
+
+  if (! multiDFA_)
+    return;
+
+  for (size_t i = 0; i < patterns.size(); ++i)
+    patterns[i]->setMultiId(int(i));
+
+  multiGen_ = -1;
+}
+
+// check if combined regexp matches line (all regexps matched once per line)
+bool
+CAwk::
+isMultiMatch(int id)
+{
+  if (multiGen_ != lineGen_) {
+    multiDFA_->findAll(line_, multiMatched_);
+
+    multiGen_ = lineGen_;
+  }
+
+  return multiMatched_[id];
+}
+
 bool
 CAwk::
 execFile(const std::string &fileName)
 {
-  FileP file;
+  using ReaderP = std::unique_ptr<CAwkRecordReader>;
 
-  if (fileName == "-") // stdin
-    file = std::make_unique<CFile>(stdin);
+  ReaderP fileReader;
+
+  if (fileName == "-") // stdin (shared with getline)
+    mainReader_ = getReader("-");
   else {
     if (! CFile::exists(fileName) || ! CFile::isRegular(fileName)) {
       error("Invalid file '" + fileName + "'");
       return false;
     }
 
-    file = std::make_unique<CFile>(fileName);
+    int fd = ::open(fileName.c_str(), O_RDONLY);
+
+    if (fd < 0) {
+      error("Failed to open '" + fileName + "'");
+      return false;
+    }
+
+    fileReader  = std::make_unique<CAwkRecordReader>(fd, /*owner*/true);
+    mainReader_ = fileReader.get();
   }
 
   getVariable("FILENAME")->getValue()->setString(fileName);
 
+  fnr_ = 0;
+
   std::string line;
 
-  while (file->readLine(line)) {
+  while (true) {
+    mainReader_->setRS(rs_);
+
+    if (! mainReader_->readRecord(line))
+      break;
+
     setLine(line);
 
+    if (getVM()) {
+      if (mainProgram_->exec() == CAwkProgram::Status::EXIT) {
+        exited_ = true;
+        break;
+      }
+
+      continue;
+    }
+
     auto p1 = patternActionList_.begin();
     auto p2 = patternActionList_.end  ();
 
@@ -306,6 +466,8 @@ execFile(const std::string &fileName)
     }
   }
 
+  mainReader_ = nullptr;
+
   return true;
 }
 
@@ -315,34 +477,57 @@ setLine(const std::string &line)
 {
   line_ = line;
 
-  setLineFields();
+  ++lineGen_;
 
-  getVariable("FNR")->getValue()->setInteger(
-    getVariable("FNR")->getValue()->getInteger() + 1);
+  // fields split on first access
+  lineFieldsSplit_ = false;
 
-  getVariable("NR")->getValue()->setInteger(
-    getVariable("NR")->getValue()->getInteger() + 1);
+  ++fnr_;
+  ++nr_;
 }
 
-const std::string &
+// get field as view into line (valid until line or fields change)
+std::string_view
 CAwk::
 getLineField(uint pos) const
 {
-  static std::string null_str;
-
   if (pos == 0)
     return line_;
 
-  if (! lineFields_) {
+  if (! lineFieldsSplit_ || (lineFieldsPartial_ && pos > lineFields_.size())) {
     auto *th = const_cast<CAwk *>(this);
 
-    th->setLineFields();
+    th->setLineFields(/*full*/lineFieldsSplit_);
   }
 
-  if (pos <= lineFields_.value().size())
-    return (lineFields_.value())[pos - 1];
+  const auto &fields = lineFields_;
+
+  if (pos <= fields.size())
+    return std::string_view(line_).substr(fields[pos - 1].pos, fields[pos - 1].len);
   else
-    return null_str;
+    return std::string_view();
+}
+
+// append field to string (without creating temporary string)
+void
+CAwk::
+appendLineField(uint pos, std::string &str) const
+{
+  if (pos == 0) {
+    str += line_;
+    return;
+  }
+
+  if (! lineFieldsSplit_ || (lineFieldsPartial_ && pos > lineFields_.size())) {
+    auto *th = const_cast<CAwk *>(this);
+
+    th->setLineFields(/*full*/lineFieldsSplit_);
+  }
+
+  const auto &fields = lineFields_;
+
+  if (pos <= fields.size())
+    str.append(line_, fields[pos - 1].pos, fields[pos - 1].len);
 }
 
 void
@@ -352,56 +537,132 @@ setLineField(uint pos, const std::string &value)
   if (pos == 0) {
     line_ = value;
 
-    setLineFields();
+    ++lineGen_;
+
+    lineFieldsSplit_ = false;
 
     return;
   }
 
-  if (! lineFields_)
-    setLineFields();
-
-  StringVectorT &fields = lineFields_.value();
+  // line is rebuilt from fields so need them all
+  StringVectorT fields;
 
-  if (pos > fields.size()) {
-    while (pos > fields.size())
-      fields.push_back("");
+  getLineFields(fields);
 
-    getVariable("NF")->getValue()->setInteger(
-      lineFields_.value().size());
-  }
+  if (pos > fields.size())
+    fields.resize(pos);
 
   fields[pos - 1] = value;
 
-  line_ = "";
+  joinLineFields(fields);
+}
+
+// copy all fields out of line
+void
+CAwk::
+getLineFields(StringVectorT &fields)
+{
+  if (! lineFieldsSplit_ || lineFieldsPartial_)
+    setLineFields(/*full*/true);
+
+  for (const auto &field : lineFields_)
+    fields.push_back(line_.substr(field.pos, field.len));
+}
+
+// rebuild line from fields
+void
+CAwk::
+joinLineFields(const StringVectorT &fields)
+{
+  std::string line;
+
+  lineFields_.clear();
 
   auto p1 = fields.begin();
   auto p2 = fields.end  ();
 
   for (int i = 0; p1 != p2; ++p1, ++i) {
     if (i > 0)
-      line_ += getVariable("OFS")->getValue()->getString();
+      line += ofs_;
 
-    line_ += *p1;
+    lineFields_.push_back(CAwkFieldSplit::Field(line.size(), (*p1).size()));
+
+    line += *p1;
   }
+
+  line_ = line;
+
+  ++lineGen_;
+
+  lineFieldsSplit_   = true;
+  lineFieldsPartial_ = false;
+
+  nf_ = int(lineFields_.size());
 }
 
+// split line into fields (only up to highest field referenced by program unless full).
+// fields are stored as offset/length into line (refilled in place) so nothing is allocated
 void
 CAwk::
-setLineFields()
+setLineFields(bool full)
 {
-  StringVectorT fields;
+  uint maxField = (full || allFields_ ? 0 : uint(maxField_));
 
-  std::string fs = getVariable("FS")->getValue()->getString();
+  lineFields_.clear();
 
-  if (fs == " ")
-    fs = " \t";
+  lineFieldsPartial_ = fieldSplit_.split(line_, lineFields_, maxField);
+  lineFieldsSplit_   = true;
 
-  CStrUtil::addFields(line_, fields, fs, /*skipEmpty*/true);
+  nf_ = int(lineFields_.size());
+}
 
-  lineFields_ = fields;
+// record field position referenced by program (-1 for unknown position)
+void
+CAwk::
+addFieldRef(int pos)
+{
+  if (pos < 0)
+    allFields_ = true;
+  else
+    maxField_ = std::max(maxField_, pos);
+}
 
-  getVariable("NF")->getValue()->setInteger(
-    lineFields_.value().size());
+int
+CAwk::
+getNF() const
+{
+  if (! lineFieldsSplit_ || lineFieldsPartial_) {
+    auto *th = const_cast<CAwk *>(this);
+
+    th->setLineFields(/*full*/true);
+  }
+
+  return nf_;
+}
+
+// current record keeps the FS it was read with so split it before FS changes
+void
+CAwk::
+setFS(const std::string &fs)
+{
+  if (! lineFieldsSplit_ || lineFieldsPartial_)
+    setLineFields(/*full*/true);
+
+  fieldSplit_.setFS(fs);
+}
+
+// assigning NF truncates or extends fields and rebuilds line
+void
+CAwk::
+setNF(int nf)
+{
+  StringVectorT fields;
+
+  getLineFields(fields);
+
+  fields.resize(std::max(nf, 0));
+
+  joinLineFields(fields);
 }
 
 CAwkValuePtr
@@ -464,10 +725,16 @@ parseFunction(CAwkFunctionPtr *function)
 
   parser_->skipChar();
 
-  // read function body
+  // read function body (args resolved to local slots)
   auto actionList = CAwkActionList::create(CAwkActionList::Type::ROUTINE);
 
-  if (! parseStatementList(&actionList))
+  parseArgs_ = args;
+
+  bool rc = parseStatementList(&actionList);
+
+  parseArgs_.clear();
+
+  if (! rc)
     return false;
 
   *function = CAwkParseFunction::create(this, name, args, actionList);
@@ -1175,6 +1442,39 @@ parseInputOutputAction(CAwkActionPtr *action)
 
     *action = CAwkCloseAction::create(expression);
   }
+  // fflush ( [ <term> ] )
+  else if (parser_->isWord("fflush")) {
+    parser_->skipChars(6);
+
+    parser_->skipSpace();
+
+    if (! parser_->isChar('(')) {
+      error("Expected '('");
+      return false;
+    }
+
+    parser_->skipChar();
+
+    parser_->skipSpace();
+
+    CAwkExpressionPtr expression;
+
+    if (! parser_->isChar(')')) {
+      if (! parseExpression(&expression))
+        return false;
+
+      parser_->skipSpace();
+    }
+
+    if (! parser_->isChar(')')) {
+      error("Expected ')'");
+      return false;
+    }
+
+    parser_->skipChar();
+
+    *action = CAwkFFlushAction::create(expression);
+  }
   // getline <var> < <term>
   // getline < <term>
   // getline <var>
@@ -1354,6 +1654,11 @@ parseExpression(CAwkExpressionPtr *expression)
   if (expression1->numTerms() == 0)
     return false;
 
+  addFieldRef(expression1->maxFieldPos());
+
+  if (getCompile())
+    expression1->compile();
+
   *expression = expression1;
 
   if (getDebug())
@@ -1391,6 +1696,11 @@ parseExpressionValue(CAwkExpressionPtr *expression)
   if (expression1->numTerms() == 0)
     return false;
 
+  addFieldRef(expression1->maxFieldPos());
+
+  if (getCompile())
+    expression1->compile();
+
   *expression = expression1;
 
   if (getDebug())
@@ -1451,8 +1761,7 @@ parseExpressionTerm(CAwkExpressionTermPtr *term, bool isValue)
     if (! parseRegularExpression(regexp))
       return false;
 
-    // TODO: regexp value ?
-    auto value = CAwkValue::create(regexp);
+    auto value = CAwkRegExpValue::create(regexp);
 
     *term = std::static_pointer_cast<CAwkExpressionTerm>(value);
   }
@@ -1713,11 +2022,15 @@ parseExpressionTerm(CAwkExpressionTermPtr *term, bool isValue)
 
       auto var = CAwkArrayVariableRef::create(name, expressionList);
 
+      resolveVariable(var);
+
       *term = std::static_pointer_cast<CAwkExpressionTerm>(var);
     }
     else {
       auto var = CAwkVariableRef::create(name);
 
+      resolveVariable(var);
+
       *term = std::static_pointer_cast<CAwkExpressionTerm>(var);
     }
   }
@@ -1752,7 +2065,7 @@ parseExpressionTerm(CAwkExpressionTermPtr *term, bool isValue)
 
         auto file = CAwkIFile::create(filePtr, CAwkIFile::Type::PIPE_COMMAND);
 
-        *term = CAwkGetLineExpr::create(var, file, /*hasValue*/false);
+        *term = CAwkGetLineExpr::create(var, file, /*hasValue*/true);
       }
       else
         parser_->setPos(save_pos);
@@ -1824,6 +2137,8 @@ parseVariable(CAwkVariableRefPtr *var)
 
   *var = CAwkVariableRef::create(name);
 
+  resolveVariable(*var);
+
   if (getDebug())
     std::cerr << *var << std::endl;
 
@@ -1917,7 +2232,10 @@ parseNumber(CAwkValuePtr *value)
 
     char c1 = parser_->getCharAt();
 
-    if (c1 == '.' || c1 == 'E') {
+    // fraction, exponent or too many digits for int is read as real
+    bool isReal = (c1 == '.' || c1 == 'e' || c1 == 'E' || parser_->getPos() - save_pos > 9);
+
+    if (isReal) {
       parser_->setPos(save_pos);
 
       double real;
@@ -2215,6 +2533,40 @@ getValue(CAwkExpressionTermPtr term)
     return CAwkValuePtr();
 }
 
+// get compiled regexp for value (regexp literal or cached dynamic regexp)
+CAwkRegExpPtr
+CAwk::
+getRegExp(CAwkValuePtr value)
+{
+  auto *regexpValue = dynamic_cast<CAwkRegExpValue *>(value.get());
+
+  if (regexpValue)
+    return regexpValue->getRegExp();
+
+  return regExpCache_.get(value->getString());
+}
+
+// get parsed printf format (cached by format string)
+CAwkFormatPtr
+CAwk::
+getFormat(const std::string &format)
+{
+  auto p = formats_.find(format);
+
+  if (p != formats_.end())
+    return (*p).second;
+
+  // limit size for programs which build many different formats
+  if (formats_.size() >= 256)
+    formats_.clear();
+
+  auto fmt = CAwkFormat::create(format);
+
+  formats_[format] = fmt;
+
+  return fmt;
+}
+
 CAwkVariableRefPtr
 CAwk::
 getVariableRef(CAwkExpressionTermPtr term)
@@ -2270,6 +2622,28 @@ getVariable(const std::string &name, bool create, bool global) const
   return CAwkVariablePtr();
 }
 
+// resolve variable to function arg slot or global slot
+void
+CAwk::
+resolveVariable(CAwkVariableRefPtr var)
+{
+  const auto &name = var->getName();
+
+  auto p = std::find(parseArgs_.begin(), parseArgs_.end(), name);
+
+  if (p != parseArgs_.end()) {
+    var->setScope(CAwkVariableRef::Scope::LOCAL, int(p - parseArgs_.begin()));
+    return;
+  }
+
+  int slot = variableMgr_.getSlot(name);
+
+  if (slot < 0)
+    slot = variableMgr_.addVariable(name, "");
+
+  var->setScope(CAwkVariableRef::Scope::GLOBAL, slot);
+}
+
 CAwkVariablePtr
 CAwk::
 addVariable(const std::string &name, bool global)
@@ -2307,6 +2681,53 @@ closeFile(const std::string &fileName)
   return fileMgr_.closeFile(fileName);
 }
 
+CAwkOutputBuffer *
+CAwk::
+getOutput(FILE *file)
+{
+  return fileMgr_.getOutput(file);
+}
+
+CAwkOutputBuffer *
+CAwk::
+getOutput(const std::string &fileName, CFileBase::Mode mode,
+          CAwkFileMgr::OutputFile **outputFile)
+{
+  return fileMgr_.getOutput(fileName, mode, outputFile);
+}
+
+CAwkRecordReader *
+CAwk::
+getReader(const std::string &fileName)
+{
+  return fileMgr_.getReader(fileName);
+}
+
+CAwkRecordReader *
+CAwk::
+getMainReader()
+{
+  if (! mainReader_)
+    return getReader("-");
+
+  return mainReader_;
+}
+
+bool
+CAwk::
+flushFile(const std::string &fileName)
+{
+  return (fileMgr_.flushFile(fileName) || pipeMgr_.flushPipe(fileName));
+}
+
+void
+CAwk::
+flushFiles()
+{
+  fileMgr_.flush();
+  pipeMgr_.flush();
+}
+
 CAwkPipe *
 CAwk::
 getPipe(const std::string &cmdName, CAwkPipe::Type type)
@@ -1,20 +1,28 @@
 #include <CAwk.h>
-#include <CPrintF.h>
 #include <CFuncs.h>
-#include <CCommand.h>
 #include <CStrUtil.h>
 #include <CReadLine.h>
 #include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+
+void
+CAwkAction::
+compile(CAwkProgram &program)
+{
+  program.addExec(this);
+}
+
+//-----------
 
 void
 CAwkNullAction::
 exec()
 {
-  std::string str = CAwkInst->getLineField(0);
-
-  std::cout << str;
+  auto *output = CAwkInst->getOutput(stdout);
 
-  std::cout << CAwkInst->getVariable("ORS")->getValue()->getString();
+  output->write(CAwkInst->getLine());
+  output->write(CAwkInst->getORS());
 }
 
 //-----------
@@ -26,6 +34,13 @@ exec()
   CAwkInst->setBreakFlag();
 }
 
+void
+CAwkBreakAction::
+compile(CAwkProgram &program)
+{
+  program.addBreak();
+}
+
 //-----------
 
 void
@@ -35,6 +50,13 @@ exec()
   CAwkInst->setContinueFlag();
 }
 
+void
+CAwkContinueAction::
+compile(CAwkProgram &program)
+{
+  program.addContinue();
+}
+
 //-----------
 
 void
@@ -44,6 +66,13 @@ exec()
   CAwkInst->setNextFlag();
 }
 
+void
+CAwkNextAction::
+compile(CAwkProgram &program)
+{
+  program.addNext();
+}
+
 //-----------
 
 void
@@ -55,6 +84,13 @@ exec()
   CAwkInst->setReturnValue(value);
 }
 
+void
+CAwkReturnAction::
+compile(CAwkProgram &program)
+{
+  program.addReturn(expression_.get());
+}
+
 void
 CAwkReturnAction::
 print(std::ostream &os) const
@@ -74,6 +110,13 @@ exec()
   CAwkInst->setExitFlag();
 }
 
+void
+CAwkExitAction::
+compile(CAwkProgram &program)
+{
+  program.addExit(expression_.get());
+}
+
 void
 CAwkExitAction::
 print(std::ostream &os) const
@@ -126,6 +169,17 @@ exec()
     actionList_->exec();
 }
 
+void
+CAwkIfAction::
+compile(CAwkProgram &program)
+{
+  int jumpFalse = program.addJumpFalse(expression_.get());
+
+  actionList_->compile(program);
+
+  program.setJump(jumpFalse, program.pos());
+}
+
 void
 CAwkIfAction::
 print(std::ostream &os) const
@@ -159,6 +213,23 @@ exec()
     actionList2_->exec();
 }
 
+void
+CAwkIfElseAction::
+compile(CAwkProgram &program)
+{
+  int jumpFalse = program.addJumpFalse(expression_.get());
+
+  actionList1_->compile(program);
+
+  int jump = program.addJump();
+
+  program.setJump(jumpFalse, program.pos());
+
+  actionList2_->compile(program);
+
+  program.setJump(jump, program.pos());
+}
+
 void
 CAwkIfElseAction::
 print(std::ostream &os) const
@@ -210,6 +281,31 @@ exec()
   }
 }
 
+void
+CAwkForAction::
+compile(CAwkProgram &program)
+{
+  program.addEval(expression1_.get());
+
+  program.startLoop();
+
+  int start = program.pos();
+
+  int jumpFalse = program.addJumpFalse(expression2_.get());
+
+  actionList_->compile(program);
+
+  int cont = program.pos();
+
+  program.addEval(expression3_.get());
+
+  program.setJump(program.addJump(), start);
+
+  program.setJump(jumpFalse, program.pos());
+
+  program.endLoop(cont, program.pos());
+}
+
 void
 CAwkForAction::
 print(std::ostream &os) const
@@ -259,6 +355,25 @@ exec()
   }
 }
 
+void
+CAwkForInAction::
+compile(CAwkProgram &program)
+{
+  int reg = program.addForInInit(var2_.get());
+
+  program.startLoop();
+
+  int next = program.addForInNext(reg, var1_.get());
+
+  actionList_->compile(program);
+
+  program.setJump(program.addJump(), next);
+
+  program.setJump(next, program.pos());
+
+  program.endLoop(next, program.pos());
+}
+
 void
 CAwkForInAction::
 print(std::ostream &os) const
@@ -303,6 +418,25 @@ exec()
   }
 }
 
+void
+CAwkWhileAction::
+compile(CAwkProgram &program)
+{
+  program.startLoop();
+
+  int start = program.pos();
+
+  int jumpFalse = program.addJumpFalse(expression_.get());
+
+  actionList_->compile(program);
+
+  program.setJump(program.addJump(), start);
+
+  program.setJump(jumpFalse, program.pos());
+
+  program.endLoop(start, program.pos());
+}
+
 void
 CAwkWhileAction::
 print(std::ostream &os) const
@@ -348,6 +482,23 @@ exec()
   while (value->getBool());
 }
 
+void
+CAwkDoWhileAction::
+compile(CAwkProgram &program)
+{
+  program.startLoop();
+
+  int start = program.pos();
+
+  actionList_->compile(program);
+
+  int cont = program.pos();
+
+  program.setJump(program.addJumpTrue(expression_.get()), start);
+
+  program.endLoop(cont, program.pos());
+}
+
 void
 CAwkDoWhileAction::
 print(std::ostream &os) const
@@ -364,6 +515,13 @@ exec()
   actionList_->exec();
 }
 
+void
+CAwkActionListAction::
+compile(CAwkProgram &program)
+{
+  actionList_->compile(program);
+}
+
 void
 CAwkActionListAction::
 print(std::ostream &os) const
@@ -411,23 +569,48 @@ print(std::ostream &os) const
 //-----------
 
 void
-CAwkGetLineAction::
+CAwkFFlushAction::
 exec()
 {
-  std::string line;
+  std::string str;
 
-  if (file_) {
-    std::string str;
+  if (expression_)
+    str = expression_->getValue()->getString();
 
-    file_->read(line);
+  if (str == "")
+    CAwkInst->flushFiles();
+  else
+    CAwkInst->flushFile(str);
+}
+
+void
+CAwkFFlushAction::
+print(std::ostream &os) const
+{
+  os << "fflush(";
+
+  if (expression_)
+    os << *expression_;
+
+  os << ")";
+}
+
+//-----------
+
+void
+CAwkGetLineAction::
+exec()
+{
+  if (file_) {
+    (void) file_->getLine(var_);
   }
   else {
     CReadLine readline;
 
-    line = readline.readLine();
-  }
+    std::string line = readline.readLine();
 
-  var_->setValue(CAwkValue::create(line));
+    var_->setValue(CAwkValue::createStrNum(line));
+  }
 }
 
 void
@@ -449,31 +632,55 @@ void
 CAwkPrintAction::
 exec()
 {
-  std::string str;
+  // expressions are evaluated before the output is resolved so any output they make
+  // (or close of this destination) is done before this line is appended
+  CAwkValueList values;
+
+  if (! fieldsOnly_) {
+    values.reserve(expressionList_.size());
+
+    for (const auto &expression : expressionList_)
+      values.push_back(expression->getValue());
+  }
+
+  // values are appended straight into the output buffer
+  auto *output = (file_ ? file_->getOutput() : CAwkInst->getOutput(stdout));
+
+  if (! output)
+    return;
+
+  appendValues(values, output->beginAppend());
+
+  output->endAppend();
+}
+
+void
+CAwkPrintAction::
+appendValues(const CAwkValueList &values, std::string &str) const
+{
+  auto *awk = CAwkInst;
 
   if (expressionList_.empty())
-    str = CAwkInst->getLineField(0);
+    awk->appendLineField(0, str);
   else {
-    auto p1 = expressionList_.begin();
-    auto p2 = expressionList_.end  ();
+    auto numExpressions = expressionList_.size();
 
-    for (int i = 0; p1 != p2; ++p1, ++i) {
+    for (size_t i = 0; i < numExpressions; ++i) {
       if (i > 0)
-        str += CAwkInst->getVariable("OFS")->getValue()->getString();
+        str += awk->getOFS();
 
-      auto value = (*p1)->getValue();
+      // plain field copied from line
+      if (fieldsOnly_) {
+        awk->appendLineField(uint(fieldPos_[i]), str);
+        continue;
+      }
 
-      if (value)
-        str += value->getString();
+      if (values[i])
+        values[i]->appendString(str);
     }
   }
 
-  str += CAwkInst->getVariable("ORS")->getValue()->getString();
-
-  if (file_)
-    file_->write(str);
-  else
-    std::cout << str;
+  str += awk->getORS();
 }
 
 void
@@ -495,6 +702,17 @@ print(std::ostream &os) const
 
 //-----------
 
+CAwkPrintFAction::
+CAwkPrintFAction(const CAwkExpressionList &expressionList, CAwkOFilePtr file) :
+ expressionList_(expressionList), file_(file)
+{
+  // constant format is parsed once
+  auto value = (! expressionList_.empty() ? expressionList_[0]->constValue() : CAwkValuePtr());
+
+  if (value)
+    format_ = CAwkFormat::create(value->getString());
+}
+
 void
 CAwkPrintFAction::
 exec()
@@ -502,56 +720,50 @@ exec()
   if (expressionList_.empty())
     return;
 
-  auto p1 = expressionList_.begin();
-  auto p2 = expressionList_.end  ();
+  // format and arguments are evaluated before the output is resolved so any output
+  // they make (or close of this destination) is done before this line is appended
+  auto format = format_;
 
-  auto value = (*p1)->getValue();
+  if (! format) {
+    auto value = expressionList_[0]->getValue();
 
-  ++p1;
+    if (! value)
+      return;
 
-  if (! value)
-    return;
+    format = CAwkInst->getFormat(value->getString());
+  }
 
-  class PrintF : public CPrintF {
-   private:
-    mutable CAwkExpressionList::iterator p1_;
-    mutable CAwkExpressionList::iterator p2_;
+  CAwkValueList values;
 
-   public:
-    PrintF(const std::string &format, CAwkExpressionList::iterator p1,
-           CAwkExpressionList::iterator p2) :
-     CPrintF(format), p1_(p1), p2_(p2) {
-    }
+  values.reserve(expressionList_.size() - 1);
 
-    int         getInt     () const override { return getValue()->getInteger(); }
-    long        getLong    () const override { return getValue()->getInteger(); }
-    long        getLongLong() const override { return getValue()->getInteger(); }
-    double      getDouble  () const override { return getValue()->getReal   (); }
-    std::string getString  () const override { return getValue()->getString (); }
+  for (size_t i = 1; i < expressionList_.size(); ++i)
+    values.push_back(expressionList_[i]->getValue());
 
-    CAwkValuePtr getValue() const {
-      CAwkValuePtr value;
+  // values are formatted straight into the output buffer
+  auto *output = (file_ ? file_->getOutput() : CAwkInst->getOutput(stdout));
 
-      if (p1_ != p2_) {
-        value = (*p1_)->getValue();
+  if (! output)
+    return;
 
-        ++p1_;
-      }
-      else
-        value = CAwkValue::create("");
+  appendValues(*format, values, output->beginAppend());
 
-      return value;
-    }
-  };
+  output->endAppend();
+}
 
-  PrintF printf(value->getString(), p1, p2);
+void
+CAwkPrintFAction::
+appendValues(const CAwkFormat &format, const CAwkValueList &values, std::string &str) const
+{
+  auto p1 = values.begin();
+  auto p2 = values.end  ();
 
-  std::string str = printf.format();
+  format.format(str, [&]() {
+    if (p1 == p2)
+      return CAwkValuePtr();
 
-  if (file_)
-    file_->write(str);
-  else
-    std::cout << str;
+    return *p1++;
+  });
 }
 
 void
@@ -575,6 +787,9 @@ exec()
 {
   auto value = expr_->getValue();
 
+  // command output must follow ours
+  CAwkInst->flushFiles();
+
   (void) system(value->getString().c_str());
 
   //std::cout << *value << std::endl;
@@ -653,6 +868,14 @@ exec()
   }
 }
 
+void
+CAwkActionList::
+compile(CAwkProgram &program) const
+{
+  for (const auto &action : actionList_)
+    action->compile(program);
+}
+
 void
 CAwkActionList::
 print(std::ostream &os) const
@@ -733,6 +956,22 @@ exec()
     actionList_->exec();
 }
 
+void
+CAwkPatternAction::
+compile(CAwkProgram &program) const
+{
+  // BEGIN, END and empty patterns always match
+  int match = -1;
+
+  if (! isBegin() && ! isEnd() &&
+      dynamic_cast<CAwkNullPattern *>(pattern_.get()) == nullptr)
+    match = program.addMatch(pattern_.get());
+
+  actionList_->compile(program);
+
+  program.setJump(match, program.pos());
+}
+
 void
 CAwkPatternAction::
 print(std::ostream &os) const
@@ -746,9 +985,80 @@ print(std::ostream &os) const
 
 //---------------
 
+CAwkOutputBuffer::
+CAwkOutputBuffer(FILE *fp, Mode mode) :
+ fp_(fp), mode_(mode)
+{
+}
+
+CAwkOutputBuffer::
+CAwkOutputBuffer(CFile *file) :
+ file_(file)
+{
+}
+
+CAwkOutputBuffer::
+~CAwkOutputBuffer()
+{
+  flush();
+}
+
+void
+CAwkOutputBuffer::
+write(const std::string &str)
+{
+  beginAppend() += str;
+
+  endAppend();
+}
+
+void
+CAwkOutputBuffer::
+endAppend()
+{
+  if      (mode_ == Mode::NONE)
+    flush();
+  else if (mode_ == Mode::LINE) {
+    if (buffer_.find('\n', appendPos_) != std::string::npos)
+      flush();
+  }
+  else {
+    if (buffer_.size() >= s_bufferSize)
+      flush();
+  }
+}
+
+void
+CAwkOutputBuffer::
+flush()
+{
+  if (buffer_.empty())
+    return;
+
+  if (fp_) {
+    (void) fwrite(buffer_.c_str(), 1, buffer_.size(), fp_);
+
+    fflush(fp_);
+  }
+  else {
+    file_->write(buffer_);
+
+    file_->flush();
+  }
+
+  buffer_.clear();
+}
+
+//---------------
+
 CAwkFileMgr::
 CAwkFileMgr()
 {
+  // leave descriptors for std files, readers and pipes
+  auto maxFiles = sysconf(_SC_OPEN_MAX);
+
+  if (maxFiles > 64)
+    setMaxOpen(uint(std::min(maxFiles - 32L, 65536L)));
 }
 
 void
@@ -762,14 +1072,26 @@ void
 CAwkFileMgr::
 term()
 {
+  // flush buffered output and close files
+  for (auto &outputFile : outputFiles_) {
+    closeOutputFile(outputFile.second);
+
+    delete outputFile.second.file;
+  }
+
+  outputFiles_.clear();
+
+  for (const auto &reader : readers_)
+    delete reader.second;
+
+  readers_.clear();
+
+  delete stdOut_; stdOut_ = nullptr;
+  delete stdErr_; stdErr_ = nullptr;
+
   delete stdInFile_ ; stdInFile_  = nullptr;
   delete stdOutFile_; stdOutFile_ = nullptr;
   delete stdErrFile_; stdErrFile_ = nullptr;
-
-  for (const auto &file : files_)
-    delete file;
-
-  files_.clear();
 }
 
 CFile *
@@ -802,51 +1124,208 @@ CFile *
 CAwkFileMgr::
 getFile(const std::string &fileName, CFileBase::Mode mode)
 {
-  auto *file = new CFile(fileName);
+  return getOutputFile(fileName, mode).file;
+}
 
-  std::string path = file->getPath();
+CAwkOutputBuffer *
+CAwkFileMgr::
+getOutput(FILE *file)
+{
+  if      (file == stdout) {
+    // line buffered if interactive
+    if (! stdOut_)
+      stdOut_ = new CAwkOutputBuffer(stdout, isatty(fileno(stdout)) ?
+                  CAwkOutputBuffer::Mode::LINE : CAwkOutputBuffer::Mode::FULL);
 
-  auto pf = files_.begin();
+    return stdOut_;
+  }
+  else if (file == stderr) {
+    if (! stdErr_)
+      stdErr_ = new CAwkOutputBuffer(stderr, CAwkOutputBuffer::Mode::NONE);
 
-  for ( ; pf != files_.end(); ++pf)
-    if ((*pf)->getPath() == path)
-      break;
+    return stdErr_;
+  }
+  else
+    assert(false);
+}
 
-  if (pf != files_.end()) {
-    delete file;
+CAwkOutputBuffer *
+CAwkFileMgr::
+getOutput(const std::string &fileName, CFileBase::Mode mode, OutputFile **outputFile)
+{
+  auto &outputFile1 = getOutputFile(fileName, mode);
 
-    file = *pf;
+  if (outputFile)
+    *outputFile = &outputFile1;
 
-    auto mode1 = file->getOpenMode();
+  return outputFile1.output;
+}
+
+void
+CAwkFileMgr::
+touchOutputFile(OutputFile *outputFile)
+{
+  if (outputFile->output && outputFile->lruPos != lru_.begin())
+    lru_.splice(lru_.begin(), lru_, outputFile->lruPos);
+}
 
-    if (mode != mode1)
-      file->open(mode);
+// get open output file (opened or reopened as needed) and mark as most recently used
+CAwkFileMgr::OutputFile &
+CAwkFileMgr::
+getOutputFile(const std::string &fileName, CFileBase::Mode mode)
+{
+  auto &outputFile = outputFiles_[fileName];
+
+  if      (! outputFile.file) {
+    outputFile.file = new CFile(fileName);
+
+    openOutputFile(outputFile, mode);
+  }
+  else if (! outputFile.output) {
+    // closed to free descriptor so continue where we left off
+    openOutputFile(outputFile, mode != outputFile.mode ? mode : CFileBase::Mode::APPEND);
   }
   else {
-    files_.push_back(file);
+    if (mode != outputFile.mode) {
+      outputFile.output->flush();
+
+      outputFile.file->open(mode);
+    }
 
-    file->open(mode);
+    touchOutputFile(&outputFile);
   }
 
-  return file;
+  outputFile.mode = mode;
+
+  return outputFile;
+}
+
+void
+CAwkFileMgr::
+openOutputFile(OutputFile &outputFile, CFileBase::Mode mode)
+{
+  // close least recently used file if at limit
+  while (lru_.size() >= maxOpen_)
+    closeOutputFile(*lru_.back());
+
+  outputFile.file->open(mode);
+
+  outputFile.output = new CAwkOutputBuffer(outputFile.file);
+
+  lru_.push_front(&outputFile);
+
+  outputFile.lruPos = lru_.begin();
+}
+
+// flush and close file (descriptor and buffer freed)
+void
+CAwkFileMgr::
+closeOutputFile(OutputFile &outputFile)
+{
+  if (! outputFile.output)
+    return;
+
+  delete outputFile.output;
+
+  outputFile.output = nullptr;
+
+  ++gen_;
+
+  outputFile.file->close();
+
+  lru_.erase(outputFile.lruPos);
+}
+
+CAwkRecordReader *
+CAwkFileMgr::
+getReader(const std::string &fileName)
+{
+  auto pr = readers_.find(fileName);
+
+  if (pr != readers_.end())
+    return (*pr).second;
+
+  CAwkRecordReader *reader = nullptr;
+
+  if (fileName == "-" || fileName == "/dev/stdin")
+    reader = new CAwkRecordReader(STDIN_FILENO);
+  else {
+    int fd = ::open(fileName.c_str(), O_RDONLY);
+
+    if (fd < 0)
+      return nullptr;
+
+    reader = new CAwkRecordReader(fd, /*owner*/true);
+  }
+
+  readers_[fileName] = reader;
+
+  return reader;
 }
 
 bool
 CAwkFileMgr::
 closeFile(const std::string &fileName)
 {
-  CFile file(fileName);
+  bool closed = false;
 
-  std::string path = file.getPath();
+  auto pr = readers_.find(fileName);
 
-  for (auto pf = files_.begin(); pf != files_.end(); ++pf) {
-    if ((*pf)->getPath() == path) {
-      files_.erase(pf);
-      return true;
-    }
+  if (pr != readers_.end()) {
+    delete (*pr).second;
+
+    readers_.erase(pr);
+
+    closed = true;
   }
 
-  return false;
+  auto po = outputFiles_.find(fileName);
+
+  if (po != outputFiles_.end()) {
+    closeOutputFile((*po).second);
+
+    delete (*po).second.file;
+
+    outputFiles_.erase(po);
+
+    closed = true;
+  }
+
+  return closed;
+}
+
+bool
+CAwkFileMgr::
+flushFile(const std::string &fileName)
+{
+  if (fileName == "/dev/stdout") {
+    if (stdOut_)
+      stdOut_->flush();
+
+    return true;
+  }
+
+  auto po = outputFiles_.find(fileName);
+
+  if (po == outputFiles_.end())
+    return false;
+
+  if ((*po).second.output)
+    (*po).second.output->flush();
+
+  return true;
+}
+
+// flush all buffered output
+void
+CAwkFileMgr::
+flush()
+{
+  if (stdOut_)
+    stdOut_->flush();
+
+  for (const auto &outputFile : lru_)
+    outputFile->output->flush();
 }
 
 //--------------
@@ -868,36 +1347,40 @@ void
 CAwkPipeMgr::
 term()
 {
-  auto p1 = pipes_.begin();
-  auto p2 = pipes_.end  ();
+  // close in open order
+  for (const auto &pipe : pipes_)
+    delete pipe;
 
-  for ( ; p1 != p2; ++p1)
-    delete *p1;
+  pipes_  .clear();
+  pipeMap_.clear();
 
-  pipes_.clear();
+  ++gen_;
 }
 
 CAwkPipe *
 CAwkPipeMgr::
 getPipe(const std::string &cmdName, CAwkPipe::Type type)
 {
-  auto p1 = pipes_.begin();
-  auto p2 = pipes_.end  ();
+  auto pp = pipeMap_.find(cmdName);
 
-  for ( ; p1 != p2; ++p1)
-    if ((*p1)->getCmdName() == cmdName)
-      break;
+  if (pp != pipeMap_.end()) {
+    auto *pipe = *(*pp).second;
+
+    if (pipe->getType() == type)
+      return pipe;
+
+    delete pipe;
+
+    pipes_.erase((*pp).second);
 
-  if (p1 != p2) {
-    if ((*p1)->getType() == type)
-      return *p1;
+    pipeMap_.erase(pp);
 
-    pipes_.erase(p1);
+    ++gen_;
   }
 
   auto *pipe = new CAwkPipe(cmdName, type);
 
-  pipes_.push_back(pipe);
+  pipeMap_[cmdName] = pipes_.insert(pipes_.end(), pipe);
 
   return pipe;
 }
@@ -906,18 +1389,46 @@ bool
 CAwkPipeMgr::
 closePipe(const std::string &cmdName)
 {
-  auto p1 = pipes_.begin();
-  auto p2 = pipes_.end  ();
+  auto pp = pipeMap_.find(cmdName);
 
-  for ( ; p1 != p2; ++p1) {
-    if ((*p1)->getCmdName() == cmdName) {
-      (*p1)->close();
-      pipes_.erase(p1);
-      return true;
-    }
-  }
+  if (pp == pipeMap_.end())
+    return false;
 
-  return false;
+  auto *pipe = *(*pp).second;
+
+  pipe->close();
+
+  delete pipe;
+
+  pipes_.erase((*pp).second);
+
+  pipeMap_.erase(pp);
+
+  ++gen_;
+
+  return true;
+}
+
+bool
+CAwkPipeMgr::
+flushPipe(const std::string &cmdName)
+{
+  auto pp = pipeMap_.find(cmdName);
+
+  if (pp == pipeMap_.end())
+    return false;
+
+  (*(*pp).second)->flush();
+
+  return true;
+}
+
+void
+CAwkPipeMgr::
+flush()
+{
+  for (const auto &pipe : pipes_)
+    pipe->flush();
 }
 
 CAwkPipe::
@@ -933,83 +1444,174 @@ CAwkPipe::
     close();
 }
 
-void
+bool
 CAwkPipe::
-close()
+readRecord(std::string &str)
 {
-  std::vector<std::string> args;
+  assert(type_ == Type::INPUT);
 
-  args.push_back("-c");
-  args.push_back(cmdName_);
+  if (eof_)
+    return false;
 
-  CCommand command("sh", "/bin/sh", args);
+  if (! reader_) {
+    if (! open("r")) {
+      eof_ = true;
+      return false;
+    }
 
-  std::string res;
+    reader_ = new CAwkRecordReader(fileno(fp_));
+  }
+
+  reader_->setRS(CAwkInst->getRS());
+
+  if (reader_->readRecord(str))
+    return true;
 
-  if      (type_ == Type::INPUT)
-    command.addStringDest(*output_);
-  else if (type_ == Type::OUTPUT) {
-    command.addStringSrc (input_);
-    command.addStringDest(res);
+  // end of input so wait for command (stays at eof until closed)
+  eof_ = true;
+
+  closeFP();
+
+  return false;
+}
+
+CAwkOutputBuffer *
+CAwkPipe::
+getOutput()
+{
+  assert(type_ == Type::OUTPUT);
+
+  if (! buffer_) {
+    if (! open("w"))
+      return nullptr;
+
+    buffer_ = new CAwkOutputBuffer(fp_);
+  }
+
+  return buffer_;
+}
+
+bool
+CAwkPipe::
+open(const char *mode)
+{
+  // our output so far must come before command's
+  CAwkInst->flushFiles();
+
+  fp_ = popen(cmdName_.c_str(), mode);
+
+  if (! fp_) {
+    CAwkInst->error("Failed to run '" + cmdName_ + "'");
+    return false;
   }
 
-  command.start();
+  return true;
+}
 
-  command.wait();
+void
+CAwkPipe::
+flush()
+{
+  if (buffer_)
+    buffer_->flush();
+}
 
-  if (type_ == Type::OUTPUT)
-    std::cout << res;
+void
+CAwkPipe::
+close()
+{
+  closeFP();
 
   opened_ = false;
 }
 
+// flush remaining output, stop reading and wait for command to finish
+void
+CAwkPipe::
+closeFP()
+{
+  delete buffer_;
+  delete reader_;
+
+  buffer_ = nullptr;
+  reader_ = nullptr;
+
+  if (fp_)
+    (void) pclose(fp_);
+
+  fp_ = nullptr;
+}
+
 //--------------
 
-bool
+int
 CAwkIFile::
 read(std::string &str) const
 {
   if      (type_ == Type::READ_FILE) {
-    auto *file = getFile();
+    auto *reader = getReader();
 
-    char buffer[256];
+    if (! reader)
+      return -1;
 
-    size_t numRead = 0;
+    reader->setRS(CAwkInst->getRS());
 
-    while (file->read((uchar *) buffer, 255, &numRead)) {
-      buffer[numRead] = '\0';
-
-      str += buffer;
-    }
-
-    return (str.size() > 0);
+    return (reader->readRecord(str) ? 1 : 0);
   }
   else if (type_ == Type::PIPE_COMMAND) {
     std::string cmdStr = file_->getValue()->getString();
 
     auto *pipe = CAwkInst->getPipe(cmdStr, CAwkPipe::Type::INPUT);
 
-    pipe->setOutput(&str);
-
-    CAwkInst->closePipe(cmdStr);
-
-    return (str.size() > 0);
+    return (pipe->readRecord(str) ? 1 : 0);
   }
   else
     assert(false);
 }
 
-CFile *
+int
+CAwkIFile::
+getLine(CAwkVariableRefPtr var) const
+{
+  std::string line;
+
+  int rc = read(line);
+
+  if (rc <= 0)
+    return rc;
+
+  if (var)
+    var->setValue(CAwkValue::createStrNum(line));
+  else if (! file_ && type_ == Type::READ_FILE)
+    CAwkInst->setLine(line);
+  else
+    CAwkInst->setLineField(0, line);
+
+  // main input and command output records are counted in NR (and FNR for main input)
+  if      (! file_ && type_ == Type::READ_FILE) {
+    if (var) {
+      CAwkInst->setNR (CAwkInst->getNR () + 1);
+      CAwkInst->setFNR(CAwkInst->getFNR() + 1);
+    }
+  }
+  else if (type_ == Type::PIPE_COMMAND)
+    CAwkInst->setNR(CAwkInst->getNR() + 1);
+
+  return rc;
+}
+
+// reader for file or next record of main input if no file
+CAwkRecordReader *
 CAwkIFile::
-getFile() const
+getReader() const
 {
   if (file_) {
     std::string fileName = file_->getValue()->getString();
 
-    return CAwkInst->getFile(fileName, CFileBase::Mode::READ);
+    return CAwkInst->getReader(fileName);
   }
   else
-    return CAwkInst->getFile(stdin);
+    return CAwkInst->getMainReader();
 }
 
 void
@@ -1022,42 +1624,80 @@ print(std::ostream &os) const
     os << "|" << *file_;
 }
 
+CAwkOFile::
+CAwkOFile(CAwkExpressionPtr expression, Type type) :
+ expression_(expression), type_(type)
+{
+  auto value = (expression_ ? expression_->constValue() : CAwkValuePtr());
+
+  if (value) {
+    isConst_ = true;
+    name_    = value->getString();
+  }
+}
+
 void
 CAwkOFile::
 write(const std::string &str)
 {
-  if      (type_ == Type::WRITE_FILE || type_ == Type::APPEND_FILE) {
-    auto *file = getFile();
+  auto *output = getOutput();
 
-    file->write(str);
-  }
-  else if (type_ == Type::PIPE_COMMAND) {
-    std::string cmdStr = expression_->getValue()->getString();
+  if (output)
+    output->write(str);
+}
+
+// output buffer for destination. The buffer for the last destination name is
+// reused until an output is closed (constant name is not re-evaluated)
+CAwkOutputBuffer *
+CAwkOFile::
+getOutput() const
+{
+  auto *awk = CAwkInst;
 
-    auto *pipe = CAwkInst->getPipe(cmdStr, CAwkPipe::Type::OUTPUT);
+  if (! expression_)
+    return awk->getOutput(stdout);
 
-    pipe->addInput(str);
+  if (! isConst_) {
+    auto value = expression_->getValue();
+
+    const auto &name = value->getString();
+
+    if (output_ && outputGen_ == awk->getOutputGen() && name == name_)
+      return touchOutput();
+
+    name_ = name;
   }
+  else {
+    if (output_ && outputGen_ == awk->getOutputGen())
+      return touchOutput();
+  }
+
+  outputFile_ = nullptr;
+
+  if      (type_ == Type::PIPE_COMMAND)
+    output_ = awk->getPipe(name_, CAwkPipe::Type::OUTPUT)->getOutput();
+  else if (type_ == Type::WRITE_FILE)
+    output_ = awk->getOutput(name_, CFileBase::Mode::APPEND, &outputFile_);
+  else if (type_ == Type::APPEND_FILE)
+    output_ = awk->getOutput(name_, CFileBase::Mode::WRITE, &outputFile_);
   else
     assert(false);
+
+  // lookup may close other outputs so get generation after
+  outputGen_ = awk->getOutputGen();
+
+  return output_;
 }
 
-CFile *
+// cached output is used again so keep its file out of the LRU close list
+CAwkOutputBuffer *
 CAwkOFile::
-getFile() const
+touchOutput() const
 {
-  if (expression_) {
-    std::string fileName = expression_->getValue()->getString();
+  if (outputFile_)
+    CAwkInst->touchOutputFile(outputFile_);
 
-    if      (type_ == Type::WRITE_FILE)
-      return CAwkInst->getFile(fileName, CFileBase::Mode::APPEND);
-    else if (type_ == Type::APPEND_FILE)
-      return CAwkInst->getFile(fileName, CFileBase::Mode::WRITE);
-    else
-      assert(false);
-  }
-  else
-    return CAwkInst->getFile(stdout);
+  return output_;
 }
 
 void
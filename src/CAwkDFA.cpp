@@ -0,0 +1,925 @@
+#include <CAwkDFA.h>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace {
+
+// max dfa states kept before the state cache is flushed
+const size_t s_maxDStates = 1024;
+
+// max nfa states (limits {n,m} expansion)
+const size_t s_maxStates = 8192;
+
+}
+
+//---
+
+CAwkDFAPtr
+CAwkDFA::
+compile(const std::string &pattern)
+{
+  std::vector<std::string> patterns;
+
+  patterns.push_back(pattern);
+
+  return compile(patterns);
+}
+
+// compile regexps into single dfa (match state of each is tagged with its index)
+CAwkDFAPtr
+CAwkDFA::
+compile(const std::vector<std::string> &patterns)
+{
+  return compilePatterns(patterns, /*reverse*/false);
+}
+
+CAwkDFAPtr
+CAwkDFA::
+compilePatterns(const std::vector<std::string> &patterns, bool reverse)
+{
+  if (patterns.empty())
+    return CAwkDFAPtr();
+
+  CAwkDFAPtr dfa(new CAwkDFA);
+
+  dfa->reverse_ = reverse;
+
+  int start = -1;
+
+  for (const auto &pattern : patterns) {
+    dfa->pattern_ = pattern;
+    dfa->pos_     = 0;
+
+    Frag frag;
+
+    if (! dfa->parseAlt(frag) || ! dfa->atEnd())
+      return CAwkDFAPtr();
+
+    if (dfa->states_.size() > s_maxStates)
+      return CAwkDFAPtr();
+
+    int match = dfa->addState(Type::MATCH);
+
+    dfa->states_[match].id = int(dfa->numPatterns_++);
+
+    dfa->patch(frag.exits, match);
+
+    start = (start < 0 ? frag.start : dfa->addState(Type::SPLIT, start, frag.start));
+  }
+
+  dfa->start_ = start;
+
+  dfa->startMid_.push_back(dfa->start_);
+
+  dfa->closure(dfa->startMid_, /*bol*/false, /*eol*/false);
+
+  return dfa;
+}
+
+// compile regexp into dfa which only matches at the start position
+CAwkDFAPtr
+CAwkDFA::
+compileAnchored(const std::string &pattern)
+{
+  auto dfa = compile(pattern);
+
+  if (dfa)
+    dfa->anchored_ = true;
+
+  return dfa;
+}
+
+// compile regexp into dfa which matches the reversed string (so scanning the string
+// backwards finds match start positions)
+CAwkDFAPtr
+CAwkDFA::
+compileReverse(const std::string &pattern)
+{
+  std::vector<std::string> patterns;
+
+  patterns.push_back(pattern);
+
+  return compilePatterns(patterns, /*reverse*/true);
+}
+
+bool
+CAwkDFA::
+find(const std::string &str) const
+{
+  if (dstates_.empty())
+    resetDStates();
+
+  int ds = 0;
+
+  if (! dstates_[ds].accepts.empty())
+    return true;
+
+  for (auto c : str) {
+    ds = nextDState(ds, static_cast<unsigned char>(c));
+
+    if (! dstates_[ds].accepts.empty())
+      return true;
+  }
+
+  return ! dstates_[ds].acceptsEnd.empty();
+}
+
+void
+CAwkDFA::
+findAll(const std::string &str, std::vector<char> &matched) const
+{
+  matched.assign(numPatterns_, 0);
+
+  uint numMatched = 0;
+
+  auto addMatched = [&](const IdList &ids) {
+    for (auto id : ids) {
+      if (! matched[id]) {
+        matched[id] = 1;
+
+        ++numMatched;
+      }
+    }
+  };
+
+  if (dstates_.empty())
+    resetDStates();
+
+  int ds = 0;
+
+  addMatched(dstates_[ds].accepts);
+
+  for (auto c : str) {
+    // stop when all matched
+    if (numMatched == numPatterns_)
+      return;
+
+    ds = nextDState(ds, static_cast<unsigned char>(c));
+
+    if (! dstates_[ds].accepts.empty())
+      addMatched(dstates_[ds].accepts);
+  }
+
+  addMatched(dstates_[ds].acceptsEnd);
+}
+
+size_t
+CAwkDFA::
+matchLength(const std::string &str, size_t pos) const
+{
+  if (dstates_.empty())
+    resetDStates();
+
+  // start of string state only at position 0
+  if (pos > 0 && midDState_ < 0)
+    midDState_ = addDState(startMid_);
+
+  int ds = (pos == 0 ? 0 : midDState_);
+
+  size_t len = str.size();
+
+  size_t matchLen = (! dstates_[ds].accepts.empty() ? 0 : std::string::npos);
+
+  for (size_t i = pos; i < len; ++i) {
+    ds = nextDState(ds, static_cast<unsigned char>(str[i]));
+
+    // no match can be extended
+    if (dstates_[ds].states.empty())
+      return matchLen;
+
+    if (! dstates_[ds].accepts.empty())
+      matchLen = i + 1 - pos;
+  }
+
+  if (! dstates_[ds].acceptsEnd.empty())
+    matchLen = len - pos;
+
+  return matchLen;
+}
+
+void
+CAwkDFA::
+findStarts(const std::string &str, std::vector<char> &starts) const
+{
+  auto len = str.size();
+
+  starts.assign(len, 0);
+
+  if (dstates_.empty())
+    resetDStates();
+
+  // initial state is end of string (so reversed '$' only matches there)
+  int ds = 0;
+
+  for (size_t i = len; i-- > 0; ) {
+    ds = nextDState(ds, static_cast<unsigned char>(str[i]));
+
+    // start of string only matches '^' at position 0
+    const auto &ids = (i == 0 ? dstates_[ds].acceptsEnd : dstates_[ds].accepts);
+
+    if (! ids.empty())
+      starts[i] = 1;
+  }
+}
+
+//---
+
+// <concat> [ '|' <concat> ]*
+bool
+CAwkDFA::
+parseAlt(Frag &frag)
+{
+  if (! parseConcat(frag))
+    return false;
+
+  while (! atEnd() && pattern_[pos_] == '|') {
+    ++pos_;
+
+    Frag frag1;
+
+    if (! parseConcat(frag1))
+      return false;
+
+    frag = altFrag(frag, frag1);
+  }
+
+  return true;
+}
+
+// <repeat>*
+bool
+CAwkDFA::
+parseConcat(Frag &frag)
+{
+  frag = emptyFrag();
+
+  while (! atEnd() && pattern_[pos_] != '|' && pattern_[pos_] != ')') {
+    Frag frag1;
+
+    if (! parseRepeat(frag1))
+      return false;
+
+    // reversed regexp matches atoms in reverse order
+    if (reverse_) {
+      concat(frag1, frag);
+
+      frag = frag1;
+    }
+    else
+      concat(frag, frag1);
+
+    if (states_.size() > s_maxStates)
+      return false;
+  }
+
+  return true;
+}
+
+// <atom> [ '*' | '+' | '?' | '{' <n> [ ',' [ <m> ] ] '}' ]*
+bool
+CAwkDFA::
+parseRepeat(Frag &frag)
+{
+  auto atomStart = pos_;
+
+  if (! parseAtom(frag))
+    return false;
+
+  auto atomEnd = pos_;
+
+  bool repeated = false;
+
+  while (! atEnd()) {
+    char c = pattern_[pos_];
+
+    if      (c == '*') {
+      ++pos_;
+
+      frag = starFrag(frag);
+    }
+    else if (c == '+') {
+      ++pos_;
+
+      // a+ = aa*
+      auto savePos = pos_;
+
+      pos_ = atomStart;
+
+      Frag frag1;
+
+      if (repeated || ! parseAtom(frag1))
+        return false;
+
+      pos_ = savePos;
+
+      concat(frag, starFrag(frag1));
+    }
+    else if (c == '?') {
+      ++pos_;
+
+      frag = questionFrag(frag);
+    }
+    else if (c == '{') {
+      // interval only supported directly after atom
+      if (repeated)
+        return false;
+
+      ++pos_;
+
+      int n = 0, m = 0;
+
+      if (! parseInteger(n))
+        return false;
+
+      bool unbounded = false;
+
+      if      (! atEnd() && pattern_[pos_] == ',') {
+        ++pos_;
+
+        if (! atEnd() && pattern_[pos_] == '}')
+          unbounded = true;
+        else if (! parseInteger(m))
+          return false;
+      }
+      else
+        m = n;
+
+      if (atEnd() || pattern_[pos_] != '}')
+        return false;
+
+      ++pos_;
+
+      if (n > 255 || m > 255 || (! unbounded && m < n))
+        return false;
+
+      auto endPos = pos_;
+
+      // build n required copies then (m - n) optional copies (or star if unbounded)
+      auto copyAtom = [&](Frag &frag1) {
+        pos_ = atomStart;
+
+        bool rc = parseAtom(frag1);
+
+        return (rc && pos_ == atomEnd);
+      };
+
+      Frag frag1 = emptyFrag();
+
+      for (int i = 0; i < n; ++i) {
+        Frag frag2;
+
+        if (i == 0)
+          frag2 = frag;
+        else if (! copyAtom(frag2))
+          return false;
+
+        concat(frag1, frag2);
+
+        if (states_.size() > s_maxStates)
+          return false;
+      }
+
+      if (unbounded) {
+        Frag frag2;
+
+        if (n == 0)
+          frag2 = frag;
+        else if (! copyAtom(frag2))
+          return false;
+
+        concat(frag1, starFrag(frag2));
+      }
+      else {
+        for (int i = n; i < m; ++i) {
+          Frag frag2;
+
+          if (i == 0)
+            frag2 = frag;
+          else if (! copyAtom(frag2))
+            return false;
+
+          concat(frag1, questionFrag(frag2));
+
+          if (states_.size() > s_maxStates)
+            return false;
+        }
+      }
+
+      pos_ = endPos;
+
+      frag = frag1;
+    }
+    else
+      break;
+
+    repeated = true;
+  }
+
+  return true;
+}
+
+// '(' <alt> ')' | '.' | '[' <bracket> ']' | '^' | '$' | '\' <char> | <char>
+bool
+CAwkDFA::
+parseAtom(Frag &frag)
+{
+  if (atEnd())
+    return false;
+
+  char c = pattern_[pos_++];
+
+  switch (c) {
+    case '(': {
+      if (! parseAlt(frag))
+        return false;
+
+      if (atEnd() || pattern_[pos_] != ')')
+        return false;
+
+      ++pos_;
+
+      break;
+    }
+    case '.': {
+      CharSet chars;
+
+      chars.set();
+
+      frag = charsFrag(chars);
+
+      break;
+    }
+    case '[': {
+      CharSet chars;
+
+      if (! parseBracket(chars))
+        return false;
+
+      frag = charsFrag(chars);
+
+      break;
+    }
+    case '^':
+      frag = emptyFrag(reverse_ ? Type::EOL : Type::BOL);
+
+      break;
+    case '$':
+      frag = emptyFrag(reverse_ ? Type::BOL : Type::EOL);
+
+      break;
+    case '\\': {
+      char c1;
+
+      if (! parseEscape(c1))
+        return false;
+
+      CharSet chars;
+
+      chars.set(static_cast<unsigned char>(c1));
+
+      frag = charsFrag(chars);
+
+      break;
+    }
+    // repeat with no atom or unmatched bracket
+    case '*': case '+': case '?': case '{': case '}': case ']': case ')':
+      return false;
+    default: {
+      CharSet chars;
+
+      chars.set(static_cast<unsigned char>(c));
+
+      frag = charsFrag(chars);
+
+      break;
+    }
+  }
+
+  return true;
+}
+
+// [^] <char> | <char>-<char> | [:<class>:] ... ]
+bool
+CAwkDFA::
+parseBracket(CharSet &chars)
+{
+  bool negate = false;
+
+  if (! atEnd() && pattern_[pos_] == '^') {
+    negate = true;
+
+    ++pos_;
+  }
+
+  bool first = true;
+
+  while (true) {
+    if (atEnd())
+      return false;
+
+    char c = pattern_[pos_];
+
+    if (c == ']' && ! first) {
+      ++pos_;
+      break;
+    }
+
+    first = false;
+
+    // escapes inside brackets differ between implementations
+    if (c == '\\')
+      return false;
+
+    // character class
+    if (c == '[' && pos_ + 1 < pattern_.size()) {
+      char c1 = pattern_[pos_ + 1];
+
+      if (c1 == '.' || c1 == '=')
+        return false;
+
+      if (c1 == ':') {
+        auto end = pattern_.find(":]", pos_ + 2);
+
+        if (end == std::string::npos)
+          return false;
+
+        auto name = pattern_.substr(pos_ + 2, end - pos_ - 2);
+
+        int (*proc)(int) = nullptr;
+
+        if      (name == "alpha" ) proc = isalpha;
+        else if (name == "digit" ) proc = isdigit;
+        else if (name == "alnum" ) proc = isalnum;
+        else if (name == "upper" ) proc = isupper;
+        else if (name == "lower" ) proc = islower;
+        else if (name == "space" ) proc = isspace;
+        else if (name == "blank" ) proc = isblank;
+        else if (name == "punct" ) proc = ispunct;
+        else if (name == "print" ) proc = isprint;
+        else if (name == "graph" ) proc = isgraph;
+        else if (name == "cntrl" ) proc = iscntrl;
+        else if (name == "xdigit") proc = isxdigit;
+        else                       return false;
+
+        for (int i = 0; i < 128; ++i)
+          if (proc(i))
+            chars.set(size_t(i));
+
+        pos_ = end + 2;
+
+        continue;
+      }
+    }
+
+    ++pos_;
+
+    // range
+    if (pos_ + 1 < pattern_.size() && pattern_[pos_] == '-' && pattern_[pos_ + 1] != ']') {
+      char c1 = pattern_[pos_ + 1];
+
+      if (c1 == '\\' || c1 == '[')
+        return false;
+
+      auto i1 = static_cast<unsigned char>(c);
+      auto i2 = static_cast<unsigned char>(c1);
+
+      if (i2 < i1)
+        return false;
+
+      for (size_t i = i1; i <= i2; ++i)
+        chars.set(i);
+
+      pos_ += 2;
+    }
+    else
+      chars.set(static_cast<unsigned char>(c));
+  }
+
+  if (negate)
+    chars.flip();
+
+  return true;
+}
+
+// only escaped punctuation (literal char) is supported
+bool
+CAwkDFA::
+parseEscape(char &c)
+{
+  if (atEnd())
+    return false;
+
+  c = pattern_[pos_++];
+
+  return (ispunct(static_cast<unsigned char>(c)) != 0);
+}
+
+bool
+CAwkDFA::
+parseInteger(int &i)
+{
+  if (atEnd() || ! isdigit(static_cast<unsigned char>(pattern_[pos_])))
+    return false;
+
+  i = 0;
+
+  while (! atEnd() && isdigit(static_cast<unsigned char>(pattern_[pos_]))) {
+    i = i*10 + (pattern_[pos_++] - '0');
+
+    if (i > 1000)
+      return false;
+  }
+
+  return true;
+}
+
+//---
+
+int
+CAwkDFA::
+addState(Type type, int out, int out1)
+{
+  State state;
+
+  state.type = type;
+  state.out  = out;
+  state.out1 = out1;
+
+  states_.push_back(state);
+
+  return int(states_.size() - 1);
+}
+
+CAwkDFA::Frag
+CAwkDFA::
+charsFrag(const CharSet &chars)
+{
+  Frag frag;
+
+  frag.start = addState(Type::CHARS);
+
+  states_[frag.start].chars = chars;
+
+  frag.exits.push_back(Exit(frag.start, 0));
+
+  return frag;
+}
+
+CAwkDFA::Frag
+CAwkDFA::
+emptyFrag(Type type)
+{
+  Frag frag;
+
+  frag.start = addState(type);
+
+  frag.exits.push_back(Exit(frag.start, 0));
+
+  return frag;
+}
+
+void
+CAwkDFA::
+patch(const Exits &exits, int state)
+{
+  for (const auto &exit : exits) {
+    if (exit.second == 0)
+      states_[exit.first].out  = state;
+    else
+      states_[exit.first].out1 = state;
+  }
+}
+
+void
+CAwkDFA::
+concat(Frag &frag1, const Frag &frag2)
+{
+  patch(frag1.exits, frag2.start);
+
+  frag1.exits = frag2.exits;
+}
+
+CAwkDFA::Frag
+CAwkDFA::
+altFrag(const Frag &frag1, const Frag &frag2)
+{
+  Frag frag;
+
+  frag.start = addState(Type::SPLIT, frag1.start, frag2.start);
+
+  frag.exits = frag1.exits;
+
+  frag.exits.insert(frag.exits.end(), frag2.exits.begin(), frag2.exits.end());
+
+  return frag;
+}
+
+CAwkDFA::Frag
+CAwkDFA::
+starFrag(const Frag &frag)
+{
+  Frag frag1;
+
+  frag1.start = addState(Type::SPLIT, frag.start);
+
+  patch(frag.exits, frag1.start);
+
+  frag1.exits.push_back(Exit(frag1.start, 1));
+
+  return frag1;
+}
+
+CAwkDFA::Frag
+CAwkDFA::
+questionFrag(const Frag &frag)
+{
+  Frag frag1;
+
+  frag1.start = addState(Type::SPLIT, frag.start);
+
+  frag1.exits = frag.exits;
+
+  frag1.exits.push_back(Exit(frag1.start, 1));
+
+  return frag1;
+}
+
+//---
+
+// expand state set with states reachable by epsilon moves.
+// result only keeps states which consume a char or accept
+void
+CAwkDFA::
+closure(StateSet &states, bool bol, bool eol) const
+{
+  std::vector<char> visited(states_.size(), 0);
+
+  StateSet stack = states;
+
+  states.clear();
+
+  while (! stack.empty()) {
+    int s = stack.back();
+
+    stack.pop_back();
+
+    if (s < 0 || visited[s])
+      continue;
+
+    visited[s] = 1;
+
+    const auto &state = states_[s];
+
+    switch (state.type) {
+      case Type::CHARS:
+      case Type::MATCH:
+        states.push_back(s);
+        break;
+      case Type::SPLIT:
+        stack.push_back(state.out1);
+        stack.push_back(state.out);
+        break;
+      case Type::EMPTY:
+        stack.push_back(state.out);
+        break;
+      case Type::BOL:
+        if (bol)
+          stack.push_back(state.out);
+        break;
+      case Type::EOL:
+        // kept so end of string check can follow it
+        if (eol)
+          stack.push_back(state.out);
+        else
+          states.push_back(s);
+        break;
+    }
+  }
+
+  std::sort(states.begin(), states.end());
+}
+
+int
+CAwkDFA::
+addDState(const StateSet &states) const
+{
+  auto p = dstateMap_.find(states);
+
+  if (p != dstateMap_.end())
+    return (*p).second;
+
+  DState dstate;
+
+  dstate.states = states;
+
+  memset(dstate.next, -1, sizeof(dstate.next));
+
+  // follow end of string anchors to check for match at end
+  StateSet endStates = states;
+
+  closure(endStates, /*bol*/false, /*eol*/true);
+
+  setAccepts(dstate, endStates);
+
+  dstates_.push_back(dstate);
+
+  int ds = int(dstates_.size() - 1);
+
+  dstateMap_[states] = ds;
+
+  return ds;
+}
+
+int
+CAwkDFA::
+nextDState(int ds, unsigned char c) const
+{
+  int next = dstates_[ds].next[c];
+
+  if (next >= 0)
+    return next;
+
+  // move on char and restart match at next position (unless anchored)
+  StateSet states;
+
+  for (auto s : dstates_[ds].states) {
+    const auto &state = states_[s];
+
+    if (state.type == Type::CHARS && state.chars.test(c))
+      states.push_back(state.out);
+  }
+
+  closure(states, /*bol*/false, /*eol*/false);
+
+  StateSet states1;
+
+  if (! anchored_)
+    std::set_union(states.begin(), states.end(), startMid_.begin(), startMid_.end(),
+                   std::back_inserter(states1));
+  else
+    states1 = states;
+
+  // flush cache if too big (states rebuilt as needed)
+  if (dstates_.size() >= s_maxDStates) {
+    resetDStates();
+
+    return addDState(states1);
+  }
+
+  next = addDState(states1);
+
+  dstates_[ds].next[c] = next;
+
+  return next;
+}
+
+// reset dfa states to initial state (start of string)
+void
+CAwkDFA::
+resetDStates() const
+{
+  dstates_  .clear();
+  dstateMap_.clear();
+
+  midDState_ = -1;
+
+  StateSet states;
+
+  states.push_back(start_);
+
+  closure(states, /*bol*/true, /*eol*/false);
+
+  // initial state is not shared as its closure depends on start of string
+  DState dstate;
+
+  dstate.states = states;
+
+  memset(dstate.next, -1, sizeof(dstate.next));
+
+  StateSet endStates;
+
+  endStates.push_back(start_);
+
+  closure(endStates, /*bol*/true, /*eol*/true);
+
+  setAccepts(dstate, endStates);
+
+  dstates_.push_back(dstate);
+}
+
+// set patterns matched by dfa state now and at end of string
+void
+CAwkDFA::
+setAccepts(DState &dstate, const StateSet &endStates) const
+{
+  for (auto s : dstate.states) {
+    if (states_[s].type == Type::MATCH)
+      dstate.accepts.push_back(states_[s].id);
+  }
+
+  for (auto s : endStates) {
+    if (states_[s].type == Type::MATCH)
+      dstate.acceptsEnd.push_back(states_[s].id);
+  }
+}
@@ -9,6 +9,8 @@ CAwkExecuteStack()
 CAwkExecuteStack::
 ~CAwkExecuteStack()
 {
+  for (auto *subStack : freeSubStacks_)
+    delete subStack;
 }
 
 void
@@ -17,14 +19,23 @@ begin()
 {
   executeSubStackStack_.push_back(executeSubStack_);
 
-  executeSubStack_ = new CAwkExecuteSubStack;
+  // reuse previously allocated sub stack
+  if (! freeSubStacks_.empty()) {
+    executeSubStack_ = freeSubStacks_.back();
+
+    freeSubStacks_.pop_back();
+  }
+  else
+    executeSubStack_ = new CAwkExecuteSubStack;
 }
 
 void
 CAwkExecuteStack::
 end()
 {
-  delete executeSubStack_;
+  executeSubStack_->reset();
+
+  freeSubStacks_.push_back(executeSubStack_);
 
   executeSubStack_ = executeSubStackStack_.back();
 
@@ -75,6 +86,13 @@ addTerm(CAwkExpressionTermPtr term)
   executeSubStack_->addTerm(term);
 }
 
+void
+CAwkExecuteStack::
+pushTerm(CAwkExpressionTermPtr term)
+{
+  executeSubStack_->pushTerm(term);
+}
+
 bool
 CAwkExecuteStack::
 checkUnstack(CAwkOperatorPtr op)
@@ -110,6 +128,17 @@ CAwkExecuteSubStack()
 {
 }
 
+void
+CAwkExecuteSubStack::
+reset()
+{
+  termList_.clear();
+  opStack_ .clear();
+
+  value_  = false;
+  lastOp_ = CAwkOperatorPtr();
+}
+
 void
 CAwkExecuteSubStack::
 addTerm(CAwkOperatorPtr op)
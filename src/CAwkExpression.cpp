@@ -27,16 +27,18 @@ void
 CAwkExpression::
 pushTerm(CAwkExpressionTermPtr term)
 {
+  compiled_ = false;
+
   if      (dynamic_cast<CAwkOperator *>(term.get()) != nullptr) {
     auto op = std::static_pointer_cast<CAwkOperator>(term);
 
-    if (value_ && op->isUnary()) {
-      if ((dynamic_cast<CAwkPostIncrementOperator *>(op.get()) == nullptr) &&
-          (dynamic_cast<CAwkPostDecrementOperator *>(op.get()) == nullptr)) {
-        auto op1 = CAwkConcatOperator::create();
+    bool postfix = ((dynamic_cast<CAwkPostIncrementOperator *>(op.get()) != nullptr) ||
+                    (dynamic_cast<CAwkPostDecrementOperator *>(op.get()) != nullptr));
 
-        pushTerm(std::static_pointer_cast<CAwkExpressionTerm>(op1));
-      }
+    if (value_ && op->isUnary() && ! postfix) {
+      auto op1 = CAwkConcatOperator::create();
+
+      pushTerm(std::static_pointer_cast<CAwkExpressionTerm>(op1));
     }
 
     termList_.push_back(term);
@@ -45,7 +47,7 @@ pushTerm(CAwkExpressionTermPtr term)
       opStack_.push_back(lastOp_);
 
     lastOp_ = op;
-    value_  = false;
+    value_  = postfix; // postfix operator result is a value
   }
   else if (term->hasValue()) {
     if (value_) {
@@ -74,6 +76,330 @@ pushTerm(CAwkExpressionTermPtr term)
 CAwkExpressionTermPtr
 CAwkExpression::
 execute()
+{
+  if (! CAwkInst->getCompile())
+    return executeTerms();
+
+  if (! compiled_)
+    compile();
+
+  return executeCode();
+}
+
+// get highest constant field position ($<n>) used by expression (-1 if any are computed)
+int
+CAwkExpression::
+maxFieldPos() const
+{
+  int maxPos = 0;
+
+  auto numTerms = termList_.size();
+
+  for (size_t i = 0; i < numTerms; ++i) {
+    if (dynamic_cast<CAwkFieldOperator *>(termList_[i].get()) == nullptr)
+      continue;
+
+    auto *value = (i + 1 < numTerms ?
+      dynamic_cast<CAwkValue *>(termList_[i + 1].get()) : nullptr);
+
+    if (! value || ! value->isInteger() || value->getInteger() < 0)
+      return -1;
+
+    maxPos = std::max(maxPos, value->getInteger());
+  }
+
+  return maxPos;
+}
+
+int
+CAwkExpression::
+fieldPos() const
+{
+  if (termList_.size() != 1)
+    return -1;
+
+  auto *field = dynamic_cast<CAwkFieldVariableRef *>(termList_[0].get());
+
+  return (field ? field->getPos() : -1);
+}
+
+CAwkValuePtr
+CAwkExpression::
+constValue() const
+{
+  if (termList_.size() != 1)
+    return CAwkValuePtr();
+
+  return std::dynamic_pointer_cast<CAwkValue>(termList_[0]);
+}
+
+// compile infix term list to postfix code (shunting yard)
+void
+CAwkExpression::
+compile()
+{
+  struct StackOp {
+    CAwkOperatorPtr op;
+    int             inst { -1 };
+  };
+
+  using OpStack = std::vector<StackOp>;
+
+  code_.clear();
+
+  OpStack opStack;
+
+  auto emit = [&](OpCode code, CAwkExpressionTermPtr term, CAwkOperatorPtr op) {
+    Inst inst;
+
+    inst.code = code;
+    inst.term = term;
+    inst.op   = op;
+
+    code_.push_back(inst);
+
+    return int(code_.size() - 1);
+  };
+
+  auto isType = [](CAwkOperatorPtr op, auto *type) {
+    using T = std::remove_pointer_t<decltype(type)>;
+
+    return (dynamic_cast<T *>(op.get()) != nullptr);
+  };
+
+  // output operator popped from stack
+  auto emitOp = [&](const StackOp &sop) {
+    if      (isType(sop.op, (CAwkLogicalAndOperator *) nullptr) ||
+             isType(sop.op, (CAwkLogicalOrOperator  *) nullptr)) {
+      emit(OpCode::BOOL, CAwkExpressionTermPtr(), CAwkOperatorPtr());
+
+      code_[sop.inst].jump = int(code_.size());
+    }
+    else if (isType(sop.op, (CAwkColonOperator *) nullptr)) {
+      code_[sop.inst].jump = int(code_.size());
+    }
+    else if (isType(sop.op, (CAwkQuestionOperator *) nullptr)) {
+      // missing ':' so false value is null
+      int jump = emit(OpCode::JUMP, CAwkExpressionTermPtr(), CAwkOperatorPtr());
+
+      code_[sop.inst].jump = int(code_.size());
+
+      emit(OpCode::PUSH, CAwkNullValue::create(), CAwkOperatorPtr());
+
+      code_[jump].jump = int(code_.size());
+    }
+    else if (isType(sop.op, (CAwkFieldOperator *) nullptr) && ! code_.empty() &&
+             code_.back().code == OpCode::PUSH &&
+             dynamic_cast<CAwkValue *>(code_.back().term.get()) != nullptr) {
+      // constant field position ($<integer>) resolved to field reference
+      auto value = std::static_pointer_cast<CAwkValue>(code_.back().term);
+
+      if (value->isInteger())
+        code_.back().term = CAwkFieldVariableRef::create(value->getInteger());
+      else
+        emit(OpCode::OPERATOR, CAwkExpressionTermPtr(), sop.op);
+    }
+    else
+      emit(OpCode::OPERATOR, CAwkExpressionTermPtr(), sop.op);
+  };
+
+  // output stacked operators which bind tighter than new operator
+  auto unstack = [&](CAwkOperatorPtr op) {
+    while (! opStack.empty()) {
+      const auto &sop = opStack.back();
+
+      if (sop.op->getPrecedence() < op->getPrecedence() ||
+          (sop.op->getPrecedence() == op->getPrecedence() &&
+           op->getDirection() == CAwkOperator::Direction::R_TO_L))
+        break;
+
+      auto sop1 = sop;
+
+      opStack.pop_back();
+
+      emitOp(sop1);
+    }
+  };
+
+  bool value = false;
+
+  for (const auto &term : termList_) {
+    if      (dynamic_cast<CAwkOperator *>(term.get()) != nullptr) {
+      auto op = std::static_pointer_cast<CAwkOperator>(term);
+
+      if      (isType(op, (CAwkPostIncrementOperator *) nullptr) ||
+               isType(op, (CAwkPostDecrementOperator *) nullptr)) {
+        // postfix operator applies to value just output
+        unstack(op);
+
+        emit(OpCode::OPERATOR, CAwkExpressionTermPtr(), op);
+
+        value = true;
+      }
+      else if (op->isUnary() && ! value) {
+        // prefix operator waits for its value
+        opStack.push_back(StackOp{op, -1});
+      }
+      else if (isType(op, (CAwkQuestionOperator *) nullptr)) {
+        unstack(op);
+
+        int inst = emit(OpCode::JUMP_FALSE, CAwkExpressionTermPtr(), CAwkOperatorPtr());
+
+        opStack.push_back(StackOp{op, inst});
+
+        value = false;
+      }
+      else if (isType(op, (CAwkColonOperator *) nullptr)) {
+        // output true value and jump over false value
+        while (! opStack.empty() &&
+               ! isType(opStack.back().op, (CAwkQuestionOperator *) nullptr)) {
+          auto sop = opStack.back();
+
+          opStack.pop_back();
+
+          emitOp(sop);
+        }
+
+        int inst = emit(OpCode::JUMP, CAwkExpressionTermPtr(), CAwkOperatorPtr());
+
+        if (! opStack.empty()) {
+          code_[opStack.back().inst].jump = int(code_.size());
+
+          opStack.pop_back();
+        }
+        else
+          CAwkInst->error("Missing '?' for ':'");
+
+        opStack.push_back(StackOp{op, inst});
+
+        value = false;
+      }
+      else {
+        unstack(op);
+
+        int inst = -1;
+
+        if      (isType(op, (CAwkLogicalAndOperator *) nullptr))
+          inst = emit(OpCode::AND, CAwkExpressionTermPtr(), CAwkOperatorPtr());
+        else if (isType(op, (CAwkLogicalOrOperator *) nullptr))
+          inst = emit(OpCode::OR, CAwkExpressionTermPtr(), CAwkOperatorPtr());
+
+        opStack.push_back(StackOp{op, inst});
+
+        value = false;
+      }
+    }
+    else if (dynamic_cast<CAwkExprFunction *>(term.get()) != nullptr ||
+             dynamic_cast<CAwkGetLineExpr  *>(term.get()) != nullptr) {
+      // executed once when reached (getline reads a record)
+      emit(OpCode::CALL, term, CAwkOperatorPtr());
+
+      value = true;
+    }
+    else if (term->hasValue()) {
+      emit(OpCode::PUSH, term, CAwkOperatorPtr());
+
+      value = true;
+    }
+    else
+      assert(false);
+  }
+
+  while (! opStack.empty()) {
+    auto sop = opStack.back();
+
+    opStack.pop_back();
+
+    emitOp(sop);
+  }
+
+  compiled_ = true;
+
+  if (CAwkInst->getDebug())
+    printCode(std::cerr);
+}
+
+// execute compiled code
+CAwkExpressionTermPtr
+CAwkExpression::
+executeCode()
+{
+  auto &executeStack = CAwkInst->getExecuteStack();
+
+  executeStack.begin();
+
+  int numCode = int(code_.size());
+
+  for (int i = 0; i < numCode; ++i) {
+    const auto &inst = code_[i];
+
+    switch (inst.code) {
+      case OpCode::PUSH:
+        executeStack.pushTerm(inst.term);
+
+        break;
+      case OpCode::CALL: {
+        auto term = inst.term->execute();
+
+        if (! term)
+          term = CAwkValue::create("");
+
+        executeStack.pushTerm(term);
+
+        break;
+      }
+      case OpCode::OPERATOR:
+        executeStack.pushTerm(inst.op->execute());
+
+        break;
+      case OpCode::AND: {
+        if (! executeStack.popValue()->getBool()) {
+          executeStack.pushTerm(CAwkValue::create(false));
+
+          i = inst.jump - 1;
+        }
+
+        break;
+      }
+      case OpCode::OR: {
+        if (executeStack.popValue()->getBool()) {
+          executeStack.pushTerm(CAwkValue::create(true));
+
+          i = inst.jump - 1;
+        }
+
+        break;
+      }
+      case OpCode::BOOL:
+        executeStack.pushTerm(CAwkValue::create(executeStack.popValue()->getBool()));
+
+        break;
+      case OpCode::JUMP_FALSE: {
+        if (! executeStack.popValue()->getBool())
+          i = inst.jump - 1;
+
+        break;
+      }
+      case OpCode::JUMP:
+        i = inst.jump - 1;
+
+        break;
+      default:
+        assert(false);
+    }
+  }
+
+  auto term = executeStack.popTerm();
+
+  executeStack.end();
+
+  return term;
+}
+
+// execute infix term list (resolving precedence on execute stack)
+CAwkExpressionTermPtr
+CAwkExpression::
+executeTerms()
 {
   auto *awk = CAwkInst;
 
@@ -102,10 +428,9 @@ execute()
 
       executeStack.addTerm(op);
     }
-    else if (dynamic_cast<CAwkExprFunction *>(term.get()) != nullptr) {
-      auto func = std::static_pointer_cast<CAwkExprFunction>(term);
-
-      auto term1 = func->execute();
+    else if (dynamic_cast<CAwkExprFunction *>(term.get()) != nullptr ||
+             dynamic_cast<CAwkGetLineExpr  *>(term.get()) != nullptr) {
+      auto term1 = term->execute();
 
       if (term1)
         executeStack.addTerm(term1);
@@ -151,26 +476,46 @@ print(std::ostream &os) const
   os << ")";
 }
 
+void
+CAwkExpression::
+printCode(std::ostream &os) const
+{
+  int i = 0;
+
+  for (const auto &inst : code_) {
+    os << i++ << ": ";
+
+    switch (inst.code) {
+      case OpCode::PUSH      : os << "push "     << *inst.term; break;
+      case OpCode::CALL      : os << "call "     << *inst.term; break;
+      case OpCode::OPERATOR  : os << "op "       << *inst.op  ; break;
+      case OpCode::AND       : os << "and "      << inst.jump ; break;
+      case OpCode::OR        : os << "or "       << inst.jump ; break;
+      case OpCode::BOOL      : os << "bool"                   ; break;
+      case OpCode::JUMP_FALSE: os << "jump_false " << inst.jump; break;
+      case OpCode::JUMP      : os << "jump "     << inst.jump ; break;
+      default                : assert(false)                  ; break;
+    }
+
+    os << std::endl;
+  }
+}
+
 //-------------
 
 CAwkValuePtr
 CAwkGetLineExpr::
 getValue() const
 {
-  std::string line;
-
-  if (file_) {
-    std::string str;
+  // 1 if record read, 0 at end of input, -1 on error
+  if (file_)
+    return CAwkValue::create(file_->getLine(var_));
 
-    file_->read(line);
-  }
-  else {
-    CReadLine readline;
+  CReadLine readline;
 
-    line = readline.readLine();
-  }
+  std::string line = readline.readLine();
 
-  auto value = CAwkValue::create(line);
+  auto value = CAwkValue::createStrNum(line);
 
   if (var_) {
     var_->setValue(value);
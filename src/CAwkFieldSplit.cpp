@@ -0,0 +1,263 @@
+#include <CAwk.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CAWK_FIELD_SPLIT_X86 1
+#include <immintrin.h>
+#endif
+
+#include <cstdint>
+
+namespace {
+
+inline bool isBlank(char c) {
+  return (c == ' ' || c == '\t' || c == '\n');
+}
+
+// scan for first separator (find) or non-separator (! find) character.
+// separator is c, or blank (space, tab or newline) when space is set
+size_t
+scanScalar(const char *str, size_t len, size_t pos, char c, bool space, bool find)
+{
+  for ( ; pos < len; ++pos) {
+    bool isSep = (space ? isBlank(str[pos]) : str[pos] == c);
+
+    if (isSep == find)
+      return pos;
+  }
+
+  return len;
+}
+
+#ifdef CAWK_FIELD_SPLIT_X86
+__attribute__((target("sse2")))
+size_t
+scanSSE2(const char *str, size_t len, size_t pos, char c, bool space, bool find)
+{
+  auto vc  = _mm_set1_epi8(space ? ' ' : c);
+  auto vt  = _mm_set1_epi8('\t');
+  auto vnl = _mm_set1_epi8('\n');
+
+  while (pos + 16 <= len) {
+    auto v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(str + pos));
+    auto m = _mm_cmpeq_epi8(v, vc);
+
+    if (space)
+      m = _mm_or_si128(m, _mm_or_si128(_mm_cmpeq_epi8(v, vt), _mm_cmpeq_epi8(v, vnl)));
+
+    uint32_t mask = uint32_t(_mm_movemask_epi8(m));
+
+    if (! find)
+      mask = ~mask & 0xFFFF;
+
+    if (mask)
+      return pos + size_t(__builtin_ctz(mask));
+
+    pos += 16;
+  }
+
+  return scanScalar(str, len, pos, c, space, find);
+}
+
+__attribute__((target("avx2")))
+size_t
+scanAVX2(const char *str, size_t len, size_t pos, char c, bool space, bool find)
+{
+  auto vc  = _mm256_set1_epi8(space ? ' ' : c);
+  auto vt  = _mm256_set1_epi8('\t');
+  auto vnl = _mm256_set1_epi8('\n');
+
+  while (pos + 32 <= len) {
+    auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(str + pos));
+    auto m = _mm256_cmpeq_epi8(v, vc);
+
+    if (space)
+      m = _mm256_or_si256(m,
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, vt), _mm256_cmpeq_epi8(v, vnl)));
+
+    uint32_t mask = uint32_t(_mm256_movemask_epi8(m));
+
+    if (! find)
+      mask = ~mask;
+
+    if (mask)
+      return pos + size_t(__builtin_ctz(mask));
+
+    pos += 32;
+  }
+
+  return scanSSE2(str, len, pos, c, space, find);
+}
+#endif
+
+using ScanProc = size_t (*)(const char *, size_t, size_t, char, bool, bool);
+
+// pick best implementation for this CPU
+ScanProc
+getScanProc()
+{
+#ifdef CAWK_FIELD_SPLIT_X86
+  __builtin_cpu_init();
+
+  if (__builtin_cpu_supports("avx2"))
+    return scanAVX2;
+
+  if (__builtin_cpu_supports("sse2"))
+    return scanSSE2;
+#endif
+
+  return scanScalar;
+}
+
+const ScanProc scanProc = getScanProc();
+
+}
+
+//---
+
+CAwkFieldSplit::
+CAwkFieldSplit(const std::string &fs)
+{
+  setFS(fs);
+}
+
+// classify separator and get compiled regular expression
+void
+CAwkFieldSplit::
+setFS(const std::string &fs)
+{
+  fs_ = fs;
+
+  if      (fs_ == " ") {
+    type_ = Type::SPACE;
+
+    regexp_.reset();
+  }
+  else if (fs_.size() <= 1) {
+    type_ = Type::CHAR;
+    c_    = (fs_.empty() ? '\0' : fs_[0]);
+
+    regexp_.reset();
+  }
+  else {
+    type_ = Type::REGEXP;
+
+    regexp_ = CAwkInst->getRegExpCache().get(fs_);
+  }
+}
+
+// use compiled regular expression (no blank or single char special cases)
+void
+CAwkFieldSplit::
+setRegExp(const CAwkRegExpPtr &regexp)
+{
+  fs_     = regexp->getPattern();
+  type_   = Type::REGEXP;
+  regexp_ = regexp;
+}
+
+bool
+CAwkFieldSplit::
+split(const std::string &str, Fields &fields, uint maxFields) const
+{
+  const char *s = str.c_str();
+
+  auto len = str.size();
+
+  if      (type_ == Type::SPACE) {
+    // runs of blanks separate fields, leading and trailing blanks ignored
+    auto pos = skipSpace(s, len, 0);
+
+    while (pos < len) {
+      if (maxFields > 0 && fields.size() >= maxFields)
+        return true;
+
+      auto end = findSpace(s, len, pos);
+
+      fields.push_back(Field(pos, end - pos));
+
+      pos = skipSpace(s, len, end);
+    }
+
+    return false;
+  }
+  else if (type_ == Type::CHAR) {
+    // each separator char ends a field (empty fields kept)
+    if (len == 0)
+      return false;
+
+    size_t pos = 0;
+
+    while (true) {
+      if (maxFields > 0 && fields.size() >= maxFields)
+        return true;
+
+      auto end = findChar(s, len, pos, c_);
+
+      fields.push_back(Field(pos, end - pos));
+
+      if (end >= len)
+        return false;
+
+      pos = end + 1;
+    }
+  }
+  else
+    return splitRegExp(str, fields, maxFields);
+}
+
+// each (non-empty) match of separator regular expression ends a field
+bool
+CAwkFieldSplit::
+splitRegExp(const std::string &str, Fields &fields, uint maxFields) const
+{
+  auto len = str.size();
+
+  if (len == 0)
+    return false;
+
+  // mark match starts once so each separator search only checks marked positions
+  if (! regexp_->findSeparatorStarts(str, starts_))
+    starts_.clear();
+
+  size_t pos = 0;
+
+  while (true) {
+    if (maxFields > 0 && fields.size() >= maxFields)
+      return true;
+
+    // find next non-empty match at or after pos
+    size_t matchStart = len, matchEnd = len;
+
+    (void) regexp_->findSeparator(str, pos, starts_, matchStart, matchEnd);
+
+    fields.push_back(Field(pos, matchStart - pos));
+
+    if (matchStart >= len)
+      return false;
+
+    pos = matchEnd;
+  }
+}
+
+//---
+
+size_t
+CAwkFieldSplit::
+findSpace(const char *str, size_t len, size_t pos)
+{
+  return scanProc(str, len, pos, ' ', /*space*/true, /*find*/true);
+}
+
+size_t
+CAwkFieldSplit::
+skipSpace(const char *str, size_t len, size_t pos)
+{
+  return scanProc(str, len, pos, ' ', /*space*/true, /*find*/false);
+}
+
+size_t
+CAwkFieldSplit::
+findChar(const char *str, size_t len, size_t pos, char c)
+{
+  return scanProc(str, len, pos, c, /*space*/false, /*find*/true);
+}
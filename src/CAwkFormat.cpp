@@ -0,0 +1,274 @@
+#include <CAwk.h>
+#include <cassert>
+#include <climits>
+#include <cstdarg>
+#include <cstring>
+
+CAwkFormat::
+CAwkFormat(const std::string &format) :
+ format_(format)
+{
+  auto len = format_.size();
+
+  std::string literal;
+
+  size_t i = 0;
+
+  while (i < len) {
+    char c = format_[i];
+
+    if (c != '%') {
+      literal += c;
+
+      ++i;
+
+      continue;
+    }
+
+    if (i + 1 < len && format_[i + 1] == '%') {
+      literal += '%';
+
+      i += 2;
+
+      continue;
+    }
+
+    // % [<flags>] [<width>|*] [.<prec>|.*] [<length>] <conv>
+    Part part;
+
+    size_t j = i + 1;
+
+    while (j < len && strchr("-+ #0", format_[j]))
+      part.flags += format_[j++];
+
+    if (j < len && format_[j] == '*') {
+      part.starWidth = true;
+
+      ++j;
+    }
+    else {
+      while (j < len && isdigit(static_cast<unsigned char>(format_[j])))
+        part.width += format_[j++];
+    }
+
+    if (j < len && format_[j] == '.') {
+      part.prec = ".";
+
+      ++j;
+
+      if (j < len && format_[j] == '*') {
+        part.starPrec = true;
+
+        ++j;
+      }
+      else {
+        while (j < len && isdigit(static_cast<unsigned char>(format_[j])))
+          part.prec += format_[j++];
+      }
+    }
+
+    // length modifiers are ignored (all values are long or double)
+    while (j < len && strchr("hlLqjzt", format_[j]))
+      ++j;
+
+    // incomplete spec is output as is
+    if (j >= len) {
+      literal += format_.substr(i);
+      break;
+    }
+
+    char conv = format_[j];
+
+    if      (strchr("di", conv))
+      part.type = Type::INTEGER;
+    else if (strchr("ouxX", conv))
+      part.type = Type::UNSIGNED;
+    else if (strchr("eEfFgG", conv))
+      part.type = Type::REAL;
+    else if (conv == 'c')
+      part.type = Type::CHAR;
+    else if (conv == 's')
+      part.type = Type::STRING;
+    else {
+      // unknown conversion is output as is
+      literal += format_.substr(i, j - i + 1);
+
+      i = j + 1;
+
+      continue;
+    }
+
+    part.conv = conv;
+
+    // char is output as one char string
+    if (part.type == Type::CHAR) {
+      part.conv = 's';
+      part.prec = "";
+    }
+
+    if (! part.starWidth && ! part.starPrec) {
+      part.text = "%" + part.flags + part.width + part.prec;
+
+      if (part.type == Type::INTEGER || part.type == Type::UNSIGNED)
+        part.text += "l";
+
+      part.text += part.conv;
+    }
+
+    addLiteral(literal);
+
+    literal = "";
+
+    parts_.push_back(part);
+
+    i = j + 1;
+  }
+
+  addLiteral(literal);
+}
+
+void
+CAwkFormat::
+addLiteral(const std::string &text)
+{
+  if (text == "")
+    return;
+
+  Part part;
+
+  part.type = Type::LITERAL;
+  part.text = text;
+
+  parts_.push_back(part);
+}
+
+void
+CAwkFormat::
+format(std::string &str, const ValueProc &valueProc) const
+{
+  auto nextValue = [&]() {
+    auto value = valueProc();
+
+    if (! value)
+      value = CAwkValue::create("");
+
+    return value;
+  };
+
+  // clamp real to long range
+  auto toLong = [](double r) {
+    if      (r != r)                 return 0L;
+    else if (r >= double(LONG_MAX)) return LONG_MAX;
+    else if (r <= double(LONG_MIN)) return LONG_MIN;
+    else                             return long(r);
+  };
+
+  for (const auto &part : parts_) {
+    if (part.type == Type::LITERAL) {
+      str += part.text;
+      continue;
+    }
+
+    // build format with '*' width/precision from arguments
+    std::string text;
+
+    if (part.starWidth || part.starPrec) {
+      text = "%" + part.flags;
+
+      if (part.starWidth)
+        text += std::to_string(toLong(nextValue()->getReal()));
+      else
+        text += part.width;
+
+      if (part.starPrec)
+        text += "." + std::to_string(std::max(toLong(nextValue()->getReal()), 0L));
+      else
+        text += part.prec;
+
+      if (part.type == Type::INTEGER || part.type == Type::UNSIGNED)
+        text += "l";
+
+      text += part.conv;
+    }
+
+    const char *fmt = (text != "" ? text.c_str() : part.text.c_str());
+
+    auto value = nextValue();
+
+    switch (part.type) {
+      case Type::INTEGER:
+        appendPrintf(str, fmt, toLong(value->getReal()));
+        break;
+      case Type::UNSIGNED:
+        appendPrintf(str, fmt, static_cast<unsigned long>(toLong(value->getReal())));
+        break;
+      case Type::REAL:
+        appendPrintf(str, fmt, value->getReal());
+        break;
+      case Type::CHAR: {
+        // number (or numeric input string) is char code, other string is its first char
+        if      (value->getType() != CAwkValue::Type::STRING && value->isReal())
+          appendChar(str, fmt, char(value->getInteger()));
+        else if (value->getString() != "")
+          appendChar(str, fmt, value->getString()[0]);
+        else
+          appendPrintf(str, fmt, "");
+
+        break;
+      }
+      case Type::STRING:
+        appendPrintf(str, fmt, value->getString().c_str());
+        break;
+      default:
+        assert(false);
+        break;
+    }
+  }
+}
+
+// append char using string format (for width and flags). placeholder is formatted
+// then replaced so a NUL char is output
+void
+CAwkFormat::
+appendChar(std::string &str, const char *fmt, char c)
+{
+  auto pos = str.size();
+
+  appendPrintf(str, fmt, "\1");
+
+  pos = str.find('\1', pos);
+
+  if (pos != std::string::npos)
+    str[pos] = c;
+}
+
+void
+CAwkFormat::
+appendPrintf(std::string &str, const char *fmt, ...)
+{
+  char buffer[256];
+
+  va_list vargs, vargs1;
+
+  va_start(vargs, fmt);
+  va_copy(vargs1, vargs);
+
+  int n = vsnprintf(buffer, sizeof(buffer), fmt, vargs);
+
+  if      (n < 0)
+    ;
+  else if (size_t(n) < sizeof(buffer))
+    str.append(buffer, size_t(n));
+  else {
+    auto pos = str.size();
+
+    str.resize(pos + size_t(n) + 1);
+
+    (void) vsnprintf(&str[pos], size_t(n) + 1, fmt, vargs1);
+
+    str.resize(pos + size_t(n));
+  }
+
+  va_end(vargs1);
+  va_end(vargs);
+}
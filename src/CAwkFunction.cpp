@@ -1,6 +1,5 @@
 #include <CAwk.h>
 #include <CFuncs.h>
-#include <CPrintF.h>
 #include <CMathRand.h>
 #include <CStrUtil.h>
 #include <CRegExp.h>
@@ -53,28 +52,50 @@ exec(const CAwkExpressionTermList &values)
     return CAwkValue::create("");
   }
 
+  // evaluate args in caller's scope
+  std::vector<CAwkValuePtr> argValues;
+
+  for (const auto &value : values)
+    argValues.push_back(value->getValue());
+
   auto block = CAwkActionBlock::create(actionList_);
 
   awk_->startBlock(block);
 
-  // assign values to args
+  // assign values to args (args are local variable slots in order)
   auto pa1 = args_.begin();
   auto pa2 = args_.end();
 
-  auto pv1 = values.begin();
-  auto pv2 = values.end  ();
+  auto pv1 = argValues.begin();
+  auto pv2 = argValues.end  ();
 
   for ( ; pa1 != pa2 && pv1 != pv2; ++pa1, ++pv1)
-    awk_->addVariable(*pa1)->setValue((*pv1)->getValue());
+    awk_->addVariable(*pa1)->setValue(*pv1);
 
   // these extra arguments are for local variables
   for ( ; pa1 != pa2; ++pa1)
     awk_->addVariable(*pa1)->setValue(CAwkValue::create(""));
 
-  // TODO: new variables are created in global scope !!
-
   // execute block
-  block->exec();
+  if (awk_->getVM()) {
+    if (! program_) {
+      program_ = CAwkProgram::create();
+
+      actionList_->compile(*program_);
+
+      program_->finish();
+    }
+
+    // pass on next/exit to caller
+    auto status = program_->exec();
+
+    if      (status == CAwkProgram::Status::EXIT)
+      awk_->setExitFlag();
+    else if (status == CAwkProgram::Status::NEXT)
+      awk_->setNextFlag();
+  }
+  else
+    block->exec();
 
   auto retValue = awk_->getReturnValue();
 
@@ -151,11 +172,7 @@ exec(const CAwkExpressionTermList &values)
     return CAwkValue::create("");
   }
 
-  std::string regstr = values[0]->getValue()->getString();
-
-  CRegExp regexp(regstr);
-
-  regexp.setExtended(true);
+  auto regexp = awk_->getRegExp(values[0]->getValue());
 
   std::string rstr = values[1]->getValue()->getString();
 
@@ -173,14 +190,14 @@ exec(const CAwkExpressionTermList &values)
 
     str = var->getValue()->getString();
 
-    count = CRegExpUtil::gregsub(str, regexp, rstr, ostr);
+    count = CRegExpUtil::gregsub(str, regexp->getRegExp(), rstr, ostr);
 
     var->setValue(CAwkValue::create(ostr));
   }
   else {
-    str = awk_->getLineField(0);
+    str = awk_->getLine();
 
-    count = CRegExpUtil::gregsub(str, regexp, rstr, ostr);
+    count = CRegExpUtil::gregsub(str, regexp->getRegExp(), rstr, ostr);
 
     awk_->setLineField(0, ostr);
   }
@@ -252,18 +269,15 @@ exec(const CAwkExpressionTermList &values)
   }
 
   std::string str1 = values[0]->getValue()->getString();
-  std::string str2 = values[1]->getValue()->getString();
-
-  CRegExp regexp(str2);
 
-  regexp.setExtended(true);
+  auto regexp = awk_->getRegExp(values[1]->getValue());
 
-  bool match = regexp.find(str1);
+  bool match = regexp->find(str1);
 
   if (match) {
     int start, end;
 
-    regexp.getMatchRange(&start, &end);
+    regexp->getMatchRange(&start, &end);
 
     awk_->getVariable("RSTART" )->setValue(CAwkValue::create(start + 1));
     awk_->getVariable("RLENGTH")->setValue(CAwkValue::create(end - start + 1));
@@ -301,23 +315,37 @@ exec(const CAwkExpressionTermList &values)
     return CAwkValue::create(0);
   }
 
-  // field separators
-  std::string fs;
+  // split into fields (FS splitter is already compiled, separator splitter is only
+  // updated when the separator changes)
+  CAwkFieldSplit::Fields fields;
 
-  if (values.size() == 3)
-    fs = values[2]->getValue()->getString();
-  else
-    fs = awk_->getVariable("FS")->getValue()->getString();
+  if (values.size() == 3) {
+    auto value = values[2]->getValue();
 
-  if (fs == " ")
-    fs = " \t";
+    // regexp literal uses its compiled regexp, string uses FS rules
+    if (dynamic_cast<CAwkRegExpValue *>(value.get())) {
+      auto regexp = awk_->getRegExp(value);
 
-  //---
+      if (! regexpLiteral_ || fieldSplit_.getRegExp() != regexp) {
+        fieldSplit_.setRegExp(regexp);
 
-  // split into fields
-  StringVectorT fields;
+        regexpLiteral_ = true;
+      }
+    }
+    else {
+      auto fs = value->getString();
 
-  CStrUtil::addFields(str, fields, fs, /*skipEmpty*/true);
+      if (regexpLiteral_ || fieldSplit_.getFS() != fs) {
+        fieldSplit_.setFS(fs);
+
+        regexpLiteral_ = false;
+      }
+    }
+
+    (void) fieldSplit_.split(str, fields);
+  }
+  else
+    (void) awk_->getFieldSplit().split(str, fields);
 
   //---
 
@@ -329,8 +357,11 @@ exec(const CAwkExpressionTermList &values)
   // strore fields in array variable
   uint numFields = fields.size();
 
+  std::string_view sv(str);
+
   for (uint i = 0; i < numFields; ++i)
-    var->setIndValue(CStrUtil::toString(i + 1), CAwkValue::create(fields[i]));
+    var->setIndValue(CStrUtil::toString(i + 1),
+                     CAwkValue::createStrNum(sv.substr(fields[i].pos, fields[i].len)));
 
   //---
 
@@ -349,48 +380,23 @@ CAwkValuePtr
 CAwkSprintfFunction::
 exec(const CAwkExpressionTermList &values)
 {
-  class PrintF : public CPrintF {
-   private:
-    const CAwkExpressionTermList &values_;
-    mutable uint                        pos_;
-
-   public:
-    PrintF(const std::string &format, const CAwkExpressionTermList &values) :
-     CPrintF(format), values_(values), pos_(1) {
-    }
-
-    int         getInt     () const override { return getValue()->getInteger(); }
-    long        getLong    () const override { return getValue()->getInteger(); }
-    long        getLongLong() const override { return getValue()->getInteger(); }
-    double      getDouble  () const override { return getValue()->getReal   (); }
-    std::string getString  () const override { return getValue()->getString (); }
-
-    CAwkValuePtr getValue() const {
-      CAwkValuePtr value;
-
-      if (pos_ < values_.size()) {
-        value = values_[pos_]->getValue();
-
-        ++pos_;
-      }
-
-      if (! value)
-        value = CAwkValue::create("");
-
-      return value;
-    }
-  };
-
   if (values.size() < 1) {
     awk_->error("Invalid number of arguments");
     return CAwkValue::create("");
   }
 
-  std::string format = values[0]->getValue()->getString();
+  auto format = awk_->getFormat(values[0]->getValue()->getString());
+
+  uint pos = 1;
+
+  std::string str;
 
-  PrintF printf(format, values);
+  format->format(str, [&]() {
+    if (pos >= values.size())
+      return CAwkValuePtr();
 
-  std::string str = printf.format();
+    return values[pos++]->getValue();
+  });
 
   return CAwkValue::create(str);
 }
@@ -411,11 +417,7 @@ exec(const CAwkExpressionTermList &values)
     return CAwkValue::create("");
   }
 
-  std::string regstr = values[0]->getValue()->getString();
-
-  CRegExp regexp(regstr);
-
-  regexp.setExtended(true);
+  auto regexp = awk_->getRegExp(values[0]->getValue());
 
   std::string rstr = values[1]->getValue()->getString();
 
@@ -433,15 +435,15 @@ exec(const CAwkExpressionTermList &values)
 
     str = var->getValue()->getString();
 
-    if (CRegExpUtil::regsub(str, regexp, rstr, ostr))
+    if (CRegExpUtil::regsub(str, regexp->getRegExp(), rstr, ostr))
       ++count;
 
     var->setValue(CAwkValue::create(ostr));
   }
   else {
-    str = awk_->getLineField(0);
+    str = awk_->getLine();
 
-    if (CRegExpUtil::regsub(str, regexp, rstr, ostr))
+    if (CRegExpUtil::regsub(str, regexp->getRegExp(), rstr, ostr))
       ++count;
 
     awk_->setLineField(0, ostr);
@@ -41,7 +41,7 @@ execute()
   else if (value1->isReal   () || value2->isReal   ())
     value = CAwkValue::create(value1->getReal   () + value2->getReal   ());
   else
-    value = CAwkValue::create("0");
+    value = CAwkValue::create(0);
 
   var->setValue(value);
 
@@ -70,7 +70,7 @@ execute()
   else if (value1->isReal   () || value2->isReal   ())
     value = CAwkValue::create(value1->getReal   () - value2->getReal   ());
   else
-    value = CAwkValue::create("0");
+    value = CAwkValue::create(0);
 
   var->setValue(value);
 
@@ -99,7 +99,7 @@ execute()
   else if (value1->isReal   () || value2->isReal   ())
     value = CAwkValue::create(value1->getReal   () * value2->getReal   ());
   else
-    value = CAwkValue::create("0");
+    value = CAwkValue::create(0);
 
   var->setValue(value);
 
@@ -126,7 +126,7 @@ execute()
   if (value1->isReal() || value2->isReal())
     value = CAwkValue::create(value1->getReal() / value2->getReal());
   else
-    value = CAwkValue::create("0");
+    value = CAwkValue::create(0);
 
   var->setValue(value);
 
@@ -159,7 +159,7 @@ execute()
               CMathGen::modulus(value1->getReal   (),
                                 value2->getReal   ()));
   else
-    value = CAwkValue::create("0");
+    value = CAwkValue::create(0);
 
   var->setValue(value);
 
@@ -190,7 +190,7 @@ execute()
     value = CAwkValue::create(CMathGen::pow(value1->getReal   (),
                                         value2->getReal   ()));
   else
-    value = CAwkValue::create("0");
+    value = CAwkValue::create(0);
 
   var->setValue(value);
 
@@ -250,7 +250,7 @@ execute()
   if (! var) {
     CAwkInst->error("value is not a variable");
 
-    result = CAwkValue::create("0");
+    result = CAwkValue::create(0);
   }
   else {
     std::string value = CAwkInst->getExecuteStack().popValue()->getString();
@@ -267,14 +267,12 @@ CAwkExpressionTermPtr
 CAwkRegExpOperator::
 execute()
 {
-  std::string value2 = CAwkInst->getExecuteStack().popValue()->getString();
+  auto        value2 = CAwkInst->getExecuteStack().popValue();
   std::string value1 = CAwkInst->getExecuteStack().popValue()->getString();
 
-  CRegExp regexp(value2);
+  auto regexp = CAwkInst->getRegExp(value2);
 
-  regexp.setExtended(true);
-
-  bool match = regexp.find(value1);
+  bool match = regexp->isMatch(value1);
 
   auto result = CAwkValue::create(match);
 
@@ -285,14 +283,12 @@ CAwkExpressionTermPtr
 CAwkNotRegExpOperator::
 execute()
 {
-  std::string value2 = CAwkInst->getExecuteStack().popValue()->getString();
+  auto        value2 = CAwkInst->getExecuteStack().popValue();
   std::string value1 = CAwkInst->getExecuteStack().popValue()->getString();
 
-  CRegExp regexp(value2);
-
-  regexp.setExtended(true);
+  auto regexp = CAwkInst->getRegExp(value2);
 
-  bool match = regexp.find(value1);
+  bool match = regexp->isMatch(value1);
 
   auto result = CAwkValue::create(! match);
 
@@ -397,7 +393,7 @@ execute()
   else if (value1->isReal   () || value2->isReal   ())
     result = CAwkValue::create(value1->getReal   () + value2->getReal   ());
   else
-    result = CAwkValue::create("0");
+    result = CAwkValue::create(0);
 
   return std::static_pointer_cast<CAwkExpressionTerm>(result);
 }
@@ -416,7 +412,7 @@ execute()
   else if (value1->isReal   () || value2->isReal   ())
     result = CAwkValue::create(value1->getReal   () - value2->getReal   ());
   else
-    result = CAwkValue::create("0");
+    result = CAwkValue::create(0);
 
   return std::static_pointer_cast<CAwkExpressionTerm>(result);
 }
@@ -435,7 +431,7 @@ execute()
   else if (value1->isReal   () || value2->isReal   ())
     result = CAwkValue::create(value1->getReal   () * value2->getReal   ());
   else
-    result = CAwkValue::create("0");
+    result = CAwkValue::create(0);
 
   return std::static_pointer_cast<CAwkExpressionTerm>(result);
 }
@@ -452,7 +448,7 @@ execute()
   if (value1->isReal() || value2->isReal())
     result = CAwkValue::create(value1->getReal() / value2->getReal());
   else
-    result = CAwkValue::create("0");
+    result = CAwkValue::create(0);
 
   return std::static_pointer_cast<CAwkExpressionTerm>(result);
 }
@@ -475,7 +471,7 @@ execute()
                CMathGen::modulus(value1->getReal   (),
                                  value2->getReal   ()));
   else
-    result = CAwkValue::create("0");
+    result = CAwkValue::create(0);
 
   return std::static_pointer_cast<CAwkExpressionTerm>(result);
 }
@@ -493,7 +489,7 @@ execute()
   else if (value->isReal())
     result = CAwkValue::create(value->getReal());
   else
-    result = CAwkValue::create("0");
+    result = CAwkValue::create(0);
 
   return std::static_pointer_cast<CAwkExpressionTerm>(result);
 }
@@ -511,7 +507,7 @@ execute()
   else if (value->isReal())
     result = CAwkValue::create(-value->getReal());
   else
-    result = CAwkValue::create("0");
+    result = CAwkValue::create(0);
 
   return std::static_pointer_cast<CAwkExpressionTerm>(result);
 }
@@ -543,7 +539,7 @@ execute()
     result = CAwkValue::create(CMathGen::pow(value1->getReal   (),
                                                   value2->getReal   ()));
   else
-    result = CAwkValue::create("0");
+    result = CAwkValue::create(0);
 
   return std::static_pointer_cast<CAwkExpressionTerm>(result);
 }
@@ -558,7 +554,7 @@ execute()
 
   if (! var) {
     CAwkInst->error("value is not a variable");
-    value2 = CAwkValue::create("0");
+    value2 = CAwkValue::create(0);
     return std::static_pointer_cast<CAwkExpressionTerm>(value2);
   }
 
@@ -569,7 +565,7 @@ execute()
   else if (value1->isReal   ())
     value2 = CAwkValue::create(value1->getReal   () + 1);
   else
-    value2 = CAwkValue::create("1");
+    value2 = CAwkValue::create(1);
 
   var->setValue(value2);
 
@@ -586,7 +582,7 @@ execute()
 
   if (! var) {
     CAwkInst->error("value is not a variable");
-    value2 = CAwkValue::create("0");
+    value2 = CAwkValue::create(0);
     return std::static_pointer_cast<CAwkExpressionTerm>(value2);
   }
 
@@ -601,8 +597,8 @@ execute()
     value2 = CAwkValue::create(value1->getReal   () + 1);
   }
   else {
-    value1 = CAwkValue::create("0");
-    value2 = CAwkValue::create("1");
+    value1 = CAwkValue::create(0);
+    value2 = CAwkValue::create(1);
   }
 
   var->setValue(value2);
@@ -620,7 +616,7 @@ execute()
 
   if (! var) {
     CAwkInst->error("value is not a variable");
-    value2 = CAwkValue::create("0");
+    value2 = CAwkValue::create(0);
     return std::static_pointer_cast<CAwkExpressionTerm>(value2);
   }
 
@@ -648,7 +644,7 @@ execute()
 
   if (! var) {
     CAwkInst->error("value is not a variable");
-    value2 = CAwkValue::create("0");
+    value2 = CAwkValue::create(0);
     return std::static_pointer_cast<CAwkExpressionTerm>(value2);
   }
 
@@ -663,7 +659,7 @@ execute()
     value2 = CAwkValue::create(value1->getReal   () - 1);
   }
   else {
-    value1 = CAwkValue::create("0");
+    value1 = CAwkValue::create(0);
     value2 = CAwkValue::create("-1");
   }
 
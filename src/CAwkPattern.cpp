@@ -4,9 +4,10 @@ bool
 CAwkRegExpPattern::
 exec()
 {
-  std::string str = CAwkInst->getLineField(0);
+  if (multiId_ >= 0)
+    return CAwkInst->isMultiMatch(multiId_);
 
-  return regexp_.find(str);
+  return regexp_.isMatch(CAwkInst->getLine());
 }
 
 void
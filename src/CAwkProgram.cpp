@@ -0,0 +1,354 @@
+#include <CAwk.h>
+
+void
+CAwkProgram::
+finish()
+{
+  Inst inst;
+
+  inst.code = OpCode::HALT;
+
+  (void) addInst(inst);
+
+  // user functions can set next/exit flags from inside an expression
+  checkFlags_ = CAwkInst->hasParseFunctions();
+
+  loops_.clear();
+}
+
+void
+CAwkProgram::
+addExec(CAwkAction *action)
+{
+  Inst inst;
+
+  inst.code   = OpCode::EXEC;
+  inst.action = action;
+
+  (void) addInst(inst);
+}
+
+void
+CAwkProgram::
+addEval(CAwkExpression *expr)
+{
+  if (! expr)
+    return;
+
+  Inst inst;
+
+  inst.code = OpCode::EVAL;
+  inst.expr = expr;
+
+  (void) addInst(inst);
+}
+
+int
+CAwkProgram::
+addJump()
+{
+  Inst inst;
+
+  inst.code = OpCode::JUMP;
+
+  return addInst(inst);
+}
+
+int
+CAwkProgram::
+addJumpFalse(CAwkExpression *expr)
+{
+  // no expression is always true
+  if (! expr)
+    return -1;
+
+  Inst inst;
+
+  inst.code = OpCode::JUMP_FALSE;
+  inst.expr = expr;
+
+  return addInst(inst);
+}
+
+int
+CAwkProgram::
+addJumpTrue(CAwkExpression *expr)
+{
+  Inst inst;
+
+  inst.code = (expr ? OpCode::JUMP_TRUE : OpCode::JUMP);
+  inst.expr = expr;
+
+  return addInst(inst);
+}
+
+int
+CAwkProgram::
+addMatch(CAwkPattern *pattern)
+{
+  Inst inst;
+
+  inst.code    = OpCode::MATCH;
+  inst.pattern = pattern;
+
+  return addInst(inst);
+}
+
+void
+CAwkProgram::
+setJump(int inst, int pos)
+{
+  if (inst >= 0)
+    code_[inst].jump = pos;
+}
+
+int
+CAwkProgram::
+addForInInit(CAwkVariableRef *var)
+{
+  Inst inst;
+
+  inst.code = OpCode::FOR_IN_INIT;
+  inst.var  = var;
+  inst.reg  = numRegs_++;
+
+  (void) addInst(inst);
+
+  return inst.reg;
+}
+
+int
+CAwkProgram::
+addForInNext(int reg, CAwkVariableRef *var)
+{
+  Inst inst;
+
+  inst.code = OpCode::FOR_IN_NEXT;
+  inst.var  = var;
+  inst.reg  = reg;
+
+  return addInst(inst);
+}
+
+void
+CAwkProgram::
+addNext()
+{
+  Inst inst;
+
+  inst.code = OpCode::NEXT;
+
+  (void) addInst(inst);
+}
+
+void
+CAwkProgram::
+addExit(CAwkExpression *expr)
+{
+  Inst inst;
+
+  inst.code = OpCode::EXIT;
+  inst.expr = expr;
+
+  (void) addInst(inst);
+}
+
+void
+CAwkProgram::
+addReturn(CAwkExpression *expr)
+{
+  Inst inst;
+
+  inst.code = OpCode::RETURN;
+  inst.expr = expr;
+
+  (void) addInst(inst);
+}
+
+void
+CAwkProgram::
+startLoop()
+{
+  loops_.push_back(Loop());
+}
+
+void
+CAwkProgram::
+endLoop(int continuePos, int breakPos)
+{
+  const auto &loop = loops_.back();
+
+  for (const auto &inst : loop.continues)
+    setJump(inst, continuePos);
+
+  for (const auto &inst : loop.breaks)
+    setJump(inst, breakPos);
+
+  loops_.pop_back();
+}
+
+void
+CAwkProgram::
+addBreak()
+{
+  if (loops_.empty()) {
+    CAwkInst->error("break not in iteration");
+    return;
+  }
+
+  loops_.back().breaks.push_back(addJump());
+}
+
+void
+CAwkProgram::
+addContinue()
+{
+  if (loops_.empty()) {
+    CAwkInst->error("continue not in iteration");
+    return;
+  }
+
+  loops_.back().continues.push_back(addJump());
+}
+
+int
+CAwkProgram::
+addInst(const Inst &inst)
+{
+  code_.push_back(inst);
+
+  return int(code_.size() - 1);
+}
+
+CAwkProgram::Status
+CAwkProgram::
+exec() const
+{
+  struct Reg {
+    StringVectorT indices;
+    uint          pos { 0 };
+  };
+
+  auto *awk = CAwkInst;
+
+  // registers are only needed for 'for in' loops so most programs do not allocate them.
+  // they are local as a function program can be called recursively
+  std::vector<Reg> regs;
+
+  if (numRegs_ > 0)
+    regs.resize(size_t(numRegs_));
+
+  int i = 0;
+
+  while (true) {
+    const auto &inst = code_[i++];
+
+    switch (inst.code) {
+      case OpCode::HALT:
+        return Status::NONE;
+      case OpCode::EXEC:
+        inst.action->exec();
+
+        break;
+      case OpCode::EVAL:
+        (void) inst.expr->execute();
+
+        break;
+      case OpCode::JUMP:
+        i = inst.jump;
+
+        continue;
+      case OpCode::JUMP_FALSE:
+        if (! inst.expr->getValue()->getBool())
+          i = inst.jump;
+
+        break;
+      case OpCode::JUMP_TRUE:
+        if (inst.expr->getValue()->getBool())
+          i = inst.jump;
+
+        break;
+      case OpCode::MATCH:
+        if (! inst.pattern->exec())
+          i = inst.jump;
+
+        break;
+      case OpCode::FOR_IN_INIT: {
+        auto &reg = regs[inst.reg];
+
+        reg.indices = inst.var->getIndices();
+        reg.pos     = 0;
+
+        continue;
+      }
+      case OpCode::FOR_IN_NEXT: {
+        auto &reg = regs[inst.reg];
+
+        if (reg.pos >= reg.indices.size()) {
+          i = inst.jump;
+
+          continue;
+        }
+
+        inst.var->setValue(CAwkValue::create(reg.indices[reg.pos++]));
+
+        continue;
+      }
+      case OpCode::NEXT:
+        return Status::NEXT;
+      case OpCode::EXIT:
+        if (inst.expr)
+          awk->setExitCode(inst.expr->getValue()->getInteger());
+
+        return Status::EXIT;
+      case OpCode::RETURN:
+        if (inst.expr)
+          awk->setReturnValue(inst.expr->getValue());
+
+        return Status::RETURN;
+      default:
+        assert(false);
+    }
+
+    if (checkFlags_) {
+      if      (awk->isExitFlag()) {
+        awk->resetExitFlag();
+        return Status::EXIT;
+      }
+      else if (awk->isNextFlag()) {
+        awk->resetNextFlag();
+        return Status::NEXT;
+      }
+    }
+  }
+}
+
+void
+CAwkProgram::
+print(std::ostream &os) const
+{
+  int i = 0;
+
+  for (const auto &inst : code_) {
+    os << i++ << ": ";
+
+    switch (inst.code) {
+      case OpCode::HALT       : os << "halt"; break;
+      case OpCode::EXEC       : os << "exec "        << *inst.action; break;
+      case OpCode::EVAL       : os << "eval "        << *inst.expr; break;
+      case OpCode::JUMP       : os << "jump "        << inst.jump; break;
+      case OpCode::JUMP_FALSE : os << "jump_false "  << *inst.expr << " " << inst.jump; break;
+      case OpCode::JUMP_TRUE  : os << "jump_true "   << *inst.expr << " " << inst.jump; break;
+      case OpCode::MATCH      : os << "match "       << *inst.pattern << " " << inst.jump; break;
+      case OpCode::FOR_IN_INIT: os << "for_in_init " << inst.reg << " " << *inst.var; break;
+      case OpCode::FOR_IN_NEXT: os << "for_in_next " << inst.reg << " " << *inst.var << " " <<
+                                      inst.jump; break;
+      case OpCode::NEXT       : os << "next"; break;
+      case OpCode::EXIT       : os << "exit"; break;
+      case OpCode::RETURN     : os << "return"; break;
+      default                 : assert(false); break;
+    }
+
+    os << std::endl;
+  }
+}
@@ -0,0 +1,229 @@
+#include <CAwkRecordReader.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+CAwkRecordReader::
+CAwkRecordReader(int fd, bool owner) :
+ fd_(fd), owner_(owner)
+{
+  setRS("\n");
+}
+
+CAwkRecordReader::
+~CAwkRecordReader()
+{
+  if (owner_ && fd_ >= 0)
+    (void) ::close(fd_);
+}
+
+void
+CAwkRecordReader::
+setRS(const std::string &rs)
+{
+  if (rs == rs_)
+    return;
+
+  rs_ = rs;
+
+  if      (rs_.empty())
+    type_ = Type::PARAGRAPH;
+  else if (rs_.size() == 1) {
+    type_ = Type::CHAR;
+    c_    = rs_[0];
+  }
+  else {
+    type_ = Type::REGEXP;
+
+    regexp_.setPattern(rs_);
+    regexp_.setExtended(true);
+  }
+}
+
+bool
+CAwkRecordReader::
+readRecord(std::string &str)
+{
+  str.clear();
+
+  if      (type_ == Type::CHAR)
+    return readChar(str);
+  else if (type_ == Type::PARAGRAPH)
+    return readParagraph(str);
+  else
+    return readRegExp(str);
+}
+
+// record ends at separator char
+bool
+CAwkRecordReader::
+readChar(std::string &str)
+{
+  size_t scan = pos_;
+
+  while (true) {
+    const char *s = data_.c_str();
+
+    auto *p = static_cast<const char *>(memchr(s + scan, c_, data_.size() - scan));
+
+    if (p) {
+      auto end = size_t(p - s);
+
+      str.assign(data_, pos_, end - pos_);
+
+      pos_ = end + 1;
+
+      return true;
+    }
+
+    // record continues in next block (fill moves record start to pos_)
+    auto offset = data_.size() - pos_;
+
+    if (! fill())
+      return readRest(str);
+
+    scan = pos_ + offset;
+  }
+}
+
+// record ends at blank line(s). leading and trailing newlines ignored
+bool
+CAwkRecordReader::
+readParagraph(std::string &str)
+{
+  while (true) {
+    while (pos_ < data_.size() && data_[pos_] == '\n')
+      ++pos_;
+
+    if (pos_ < data_.size())
+      break;
+
+    if (! fill())
+      return false;
+  }
+
+  size_t scan = pos_;
+
+  while (true) {
+    auto end = data_.find("\n\n", scan);
+
+    if (end != std::string::npos) {
+      str.assign(data_, pos_, end - pos_);
+
+      pos_ = end + 2;
+
+      return true;
+    }
+
+    // separator may start at last char
+    auto offset = data_.size() - pos_ - 1;
+
+    if (! fill()) {
+      (void) readRest(str);
+
+      while (! str.empty() && str.back() == '\n')
+        str.pop_back();
+
+      return true;
+    }
+
+    scan = pos_ + offset;
+  }
+}
+
+// record ends at (non-empty) match of separator regular expression. Searched in
+// a growing window from the record start so a match at the window end (which may
+// continue) is only used at end of input
+bool
+CAwkRecordReader::
+readRegExp(std::string &str)
+{
+  size_t window = 256;
+
+  while (true) {
+    while (data_.size() - pos_ < window && ! eof_)
+      (void) fill();
+
+    auto len = std::min(window, data_.size() - pos_);
+
+    if (len == 0)
+      return false;
+
+    bool atEnd = (eof_ && pos_ + len == data_.size());
+
+    if (regexp_.find(data_.substr(pos_, len))) {
+      int start, end;
+
+      regexp_.getMatchRange(&start, &end);
+
+      if (end >= start && (atEnd || size_t(end) + 1 < len)) {
+        str.assign(data_, pos_, size_t(start));
+
+        pos_ += size_t(end) + 1;
+
+        return true;
+      }
+    }
+
+    if (atEnd)
+      return readRest(str);
+
+    window *= 2;
+  }
+}
+
+// rest of input is last record
+bool
+CAwkRecordReader::
+readRest(std::string &str)
+{
+  if (pos_ >= data_.size())
+    return false;
+
+  str.assign(data_, pos_, std::string::npos);
+
+  pos_ = data_.size();
+
+  return true;
+}
+
+// read next block of input after unread data (moved to start of buffer).
+// false at end of input
+bool
+CAwkRecordReader::
+fill()
+{
+  if (eof_ || fd_ < 0) {
+    eof_ = true;
+    return false;
+  }
+
+  if (pos_ > 0) {
+    data_.erase(0, pos_);
+
+    pos_ = 0;
+  }
+
+  auto size = data_.size();
+
+  data_.resize(size + s_blockSize);
+
+  while (true) {
+    auto n = ::read(fd_, &data_[size], s_blockSize);
+
+    if (n > 0) {
+      data_.resize(size + size_t(n));
+      return true;
+    }
+
+    if (n < 0 && errno == EINTR)
+      continue;
+
+    data_.resize(size);
+
+    eof_ = true;
+
+    return false;
+  }
+}
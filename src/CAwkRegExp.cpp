@@ -0,0 +1,329 @@
+#include <CAwk.h>
+#include <cstring>
+
+CAwkRegExp::
+CAwkRegExp(const std::string &pattern, bool extended) :
+ regexp_(pattern)
+{
+  regexp_.setExtended(extended);
+
+  if (extended) {
+    if (CAwkInst->getDFA())
+      dfa_ = CAwkDFA::compile(pattern);
+
+    literal_ = requiredLiteral(pattern);
+  }
+}
+
+bool
+CAwkRegExp::
+isMatch(const std::string &str) const
+{
+  // reject strings without required literal before running regexp
+  if      (literal_.size() == 1) {
+    if (! memchr(str.c_str(), literal_[0], str.size()))
+      return false;
+  }
+  else if (! literal_.empty()) {
+    if (! memmem(str.c_str(), str.size(), literal_.c_str(), literal_.size()))
+      return false;
+  }
+
+  if (dfa_)
+    return dfa_->find(str);
+
+  return regexp_.find(str);
+}
+
+bool
+CAwkRegExp::
+findSeparatorStarts(const std::string &str, Starts &starts) const
+{
+  if (! separatorInit_) {
+    anchoredDFA_ = CAwkDFA::compileAnchored(getPattern());
+
+    if (anchoredDFA_)
+      reverseDFA_ = CAwkDFA::compileReverse(getPattern());
+
+    separatorInit_ = true;
+  }
+
+  if (! reverseDFA_)
+    return false;
+
+  reverseDFA_->findStarts(str, starts);
+
+  return true;
+}
+
+bool
+CAwkRegExp::
+findSeparator(const std::string &str, size_t pos, const Starts &starts,
+              size_t &start, size_t &end) const
+{
+  auto len = str.size();
+
+  if (! starts.empty()) {
+    // longest match at each marked start (only empty matches can fail)
+    for (size_t spos = pos; spos < len; ++spos) {
+      if (! starts[spos])
+        continue;
+
+      auto matchLen = anchoredDFA_->matchLength(str, spos);
+
+      if (matchLen != std::string::npos && matchLen > 0) {
+        start = spos;
+        end   = spos + matchLen;
+
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  // CRegExp has no start offset so the remaining string is searched (and a '^' can
+  // match at its start). only used for regexps the DFA does not support
+  for (size_t spos = pos; spos < len; ) {
+    separatorStr_.assign(str, spos, std::string::npos);
+
+    if (! regexp_.find(separatorStr_))
+      return false;
+
+    int start1, end1;
+
+    regexp_.getMatchRange(&start1, &end1);
+
+    if (end1 >= start1) {
+      start = spos + size_t(start1);
+      end   = spos + size_t(end1) + 1;
+
+      return true;
+    }
+
+    spos += size_t(start1) + 1;
+  }
+
+  return false;
+}
+
+// get longest run of literal chars which every match must contain.
+// returns empty string if there is none or the pattern is not understood
+std::string
+CAwkRegExp::
+requiredLiteral(const std::string &pattern)
+{
+  std::string literal, run;
+
+  auto endRun = [&]() {
+    if (run.size() > literal.size())
+      literal = run;
+
+    run = "";
+  };
+
+  auto len = pattern.size();
+
+  size_t i = 0;
+
+  // skip repeats after non-literal atom
+  auto skipRepeat = [&]() {
+    while (i < len && strchr("*+?{", pattern[i])) {
+      if (pattern[i] == '{') {
+        auto end = pattern.find('}', i);
+
+        if (end == std::string::npos)
+          return false;
+
+        i = end + 1;
+      }
+      else
+        ++i;
+    }
+
+    return true;
+  };
+
+  while (i < len) {
+    char c = pattern[i];
+
+    // alternation at top level means no single required literal
+    if (c == '|')
+      return "";
+
+    // skip group or bracket expression
+    if (c == '(' || c == '[') {
+      int depth = 0;
+
+      while (i < len) {
+        char c1 = pattern[i++];
+
+        if      (c1 == '\\')
+          ++i;
+        else if (c1 == '[') {
+          // bracket contents are literal (']' first is part of set)
+          if (i < len && pattern[i] == '^') ++i;
+          if (i < len && pattern[i] == ']') ++i;
+
+          while (i < len && pattern[i] != ']') {
+            if (pattern[i] == '[' && i + 1 < len && strchr(":.=", pattern[i + 1])) {
+              auto end = pattern.find(std::string(1, pattern[i + 1]) + "]", i + 2);
+
+              if (end == std::string::npos)
+                return "";
+
+              i = end + 2;
+            }
+            else
+              ++i;
+          }
+
+          if (i >= len)
+            return "";
+
+          ++i;
+        }
+        else if (c1 == '(')
+          ++depth;
+        else if (c1 == ')')
+          --depth;
+
+        if (depth == 0)
+          break;
+      }
+
+      if (depth != 0)
+        return "";
+
+      endRun();
+
+      if (! skipRepeat())
+        return "";
+
+      continue;
+    }
+
+    // get literal char
+    char lc;
+
+    if      (c == '\\') {
+      if (i + 1 >= len || ! ispunct(static_cast<unsigned char>(pattern[i + 1])))
+        return "";
+
+      lc = pattern[i + 1];
+
+      i += 2;
+    }
+    else if (strchr(".^$", c)) {
+      endRun();
+
+      ++i;
+
+      if (! skipRepeat())
+        return "";
+
+      continue;
+    }
+    else if (strchr("*+?{})]", c)) {
+      // repeat without atom
+      return "";
+    }
+    else {
+      lc = c;
+
+      ++i;
+    }
+
+    // char followed by optional repeat is not required
+    char nc = (i < len ? pattern[i] : '\0');
+
+    if      (nc == '*' || nc == '?' || nc == '{') {
+      endRun();
+
+      ++i;
+
+      if (nc == '{') {
+        auto end = pattern.find('}', i);
+
+        if (end == std::string::npos)
+          return "";
+
+        i = end + 1;
+      }
+    }
+    else if (nc == '+') {
+      run += lc;
+
+      endRun();
+
+      ++i;
+    }
+    else
+      run += lc;
+  }
+
+  endRun();
+
+  return literal;
+}
+
+//---
+
+CAwkRegExpPtr
+CAwkRegExpCache::
+get(const std::string &pattern, bool extended)
+{
+  // key is flags and pattern text
+  std::string key = (extended ? "E:" : "B:") + pattern;
+
+  auto p = map_.find(key);
+
+  if (p != map_.end()) {
+    ++hits_;
+
+    // move to front of list
+    list_.splice(list_.begin(), list_, (*p).second);
+
+    return (*p).second->regexp;
+  }
+
+  ++misses_;
+
+  auto regexp = std::make_shared<CAwkRegExp>(pattern, extended);
+
+  list_.push_front(Entry());
+
+  list_.front().key    = key;
+  list_.front().regexp = regexp;
+
+  map_[key] = list_.begin();
+
+  setMaxSize(maxSize_);
+
+  return regexp;
+}
+
+// set max entries (least recently used entries removed)
+void
+CAwkRegExpCache::
+setMaxSize(uint maxSize)
+{
+  maxSize_ = std::max(maxSize, 1U);
+
+  while (list_.size() > maxSize_) {
+    map_.erase(list_.back().key);
+
+    list_.pop_back();
+  }
+}
+
+void
+CAwkRegExpCache::
+clear()
+{
+  list_.clear();
+  map_ .clear();
+
+  hits_   = 0;
+  misses_ = 0;
+}
@@ -1,5 +1,10 @@
 #include <CAwk.h>
-#include <CStrUtil.h>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <charconv>
 
 CAwkValuePtr
 CAwkValue::
@@ -36,138 +41,302 @@ create(bool value)
   return CAwkValuePtr(new CAwkValue(value));
 }
 
+CAwkValuePtr
+CAwkValue::
+createStrNum(std::string_view value)
+{
+  return CAwkValuePtr(new CAwkValue(value, /*strNum*/true));
+}
+
 //-------------
 
 CAwkValue::
 CAwkValue(const std::string &value) :
- value_(value)
+ str_(value)
 {
 }
 
 CAwkValue::
 CAwkValue(const char *value) :
- value_(value)
+ str_(value)
 {
 }
 
 CAwkValue::
-CAwkValue(double value) :
- value_(CStrUtil::toString(value))
+CAwkValue(std::string_view value, bool strNum) :
+ str_(value), strNum_(strNum)
 {
 }
 
 CAwkValue::
-CAwkValue(int value) :
- value_(CStrUtil::toString(value))
+CAwkValue(double value)
 {
+  setNumber(value);
 }
 
 CAwkValue::
-CAwkValue(bool value) :
- value_(value ? "1" : "0")
+CAwkValue(int value)
 {
+  setNumber(value);
+}
+
+CAwkValue::
+CAwkValue(bool value)
+{
+  setNumber(value ? 1 : 0);
+}
+
+CAwkValue::Type
+CAwkValue::
+getType() const
+{
+  classify();
+
+  return type_;
 }
 
 bool
 CAwkValue::
 isReal() const
 {
-  return CStrUtil::isReal(value_);
+  classify();
+
+  return isReal_;
 }
 
 bool
 CAwkValue::
 isInteger() const
 {
-  return CStrUtil::isInteger(value_);
+  classify();
+
+  return isInteger_;
 }
 
 bool
 CAwkValue::
 isBool() const
 {
-  return (value_ == "1" || value_ == "0");
+  if (type_ == Type::NUMBER)
+    return (real_ == 0.0 || real_ == 1.0);
+
+  return (str_ == "1" || str_ == "0");
 }
 
-std::string
+const std::string &
 CAwkValue::
 getString() const
 {
-  return value_;
+  // reformat if CONVFMT changed
+  if (! strValid_ || (fmtId_ != 0 && fmtId_ != CAwkInst->getCONVFMT().getId()))
+    format();
+
+  return str_;
+}
+
+void
+CAwkValue::
+appendString(std::string &str) const
+{
+  // numbers are output using OFMT
+  if (type_ == Type::NUMBER) {
+    CAwkInst->getOFMT().append(str, real_);
+    return;
+  }
+
+  str += str_;
 }
 
 double
 CAwkValue::
 getReal() const
 {
-  if      (CStrUtil::isReal(value_))
-    return CStrUtil::toReal(value_);
-  else if (CStrUtil::isInteger(value_))
-    return CStrUtil::toInteger(value_);
-  else
-    return 0.0;
+  classify();
+
+  return real_;
 }
 
 int
 CAwkValue::
 getInteger() const
 {
-  if      (CStrUtil::isInteger(value_))
-    return CStrUtil::toInteger(value_);
-  else if (CStrUtil::isReal(value_))
-    return int(CStrUtil::toReal(value_));
-  else
+  classify();
+
+  // saturate before conversion (undefined for nan or out of range)
+  if (std::isnan(real_))
     return 0;
+
+  if (real_ <= double(INT_MIN)) return INT_MIN;
+  if (real_ >= double(INT_MAX)) return INT_MAX;
+
+  return int(real_);
 }
 
 bool
 CAwkValue::
 getBool() const
 {
-  return (value_ != "" && value_ != "0");
+  if (type_ == Type::NUMBER)
+    return (real_ != 0.0);
+
+  // strnum is tested by numeric value, other strings by being non-empty
+  if (getType() == Type::STRNUM)
+    return (real_ != 0.0);
+
+  return ! str_.empty();
 }
 
 void
 CAwkValue::
 setValue(CAwkValuePtr value)
 {
-  value_ = value->value_;
+  type_       = value->type_;
+  str_        = value->str_;
+  strNum_     = value->strNum_;
+  real_       = value->real_;
+  strValid_   = value->strValid_;
+  classified_ = value->classified_;
+  isReal_     = value->isReal_;
+  isInteger_  = value->isInteger_;
+  fmtId_      = value->fmtId_;
 }
 
 void
 CAwkValue::
 setString(const std::string &value)
 {
-  value_ = value;
+  type_       = Type::STRING;
+  str_        = value;
+  strNum_     = false;
+  strValid_   = true;
+  classified_ = false;
+  fmtId_      = 0;
 }
 
 void
 CAwkValue::
 setReal(double value)
 {
-  value_ = CStrUtil::toString(value);
+  setNumber(value);
 }
 
 void
 CAwkValue::
 setInteger(int value)
 {
-  value_ = CStrUtil::toString(value);
+  setNumber(value);
 }
 
 void
 CAwkValue::
 setBool(bool value)
 {
-  value_ = (value ? "1" : "0");
+  setNumber(value ? 1 : 0);
+}
+
+void
+CAwkValue::
+setNumber(double value)
+{
+  type_       = Type::NUMBER;
+  strNum_     = false;
+  real_       = value;
+  strValid_   = false;
+  classified_ = true;
+  isReal_     = true;
+  // range checked before int conversion (undefined for inf, nan or out of range)
+  isInteger_  = (value >= double(INT_MIN) && value <= double(INT_MAX) &&
+                 value == double(int(value)));
+  fmtId_      = 0;
+}
+
+// classify string as number (once) and cache numeric value.
+// Single pass: a numeric string is an optionally signed decimal number with
+// optional surrounding blanks (no hex, inf or nan)
+void
+CAwkValue::
+classify() const
+{
+  if (classified_)
+    return;
+
+  classified_ = true;
+
+  isReal_    = false;
+  isInteger_ = false;
+  real_      = 0.0;
+
+  auto isBlank = [](char c) {
+    return (c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v');
+  };
+
+  const char *s = str_.c_str();
+  const char *e = s + str_.size();
+
+  while (s < e && isBlank(*s))
+    ++s;
+
+  while (e > s && isBlank(e[-1]))
+    --e;
+
+  bool negative = false;
+
+  if (s < e && (*s == '+' || *s == '-')) {
+    negative = (*s == '-');
+
+    ++s;
+  }
+
+  if (s >= e || ! (isdigit(*s) || *s == '.'))
+    return;
+
+  double r = 0.0;
+
+  auto res = std::from_chars(s, e, r, std::chars_format::general);
+
+  if (res.ptr != e)
+    return;
+
+  if      (res.ec == std::errc::result_out_of_range)
+    r = ::strtod(std::string(s, e).c_str(), nullptr);
+  else if (res.ec != std::errc())
+    return;
+
+  real_ = (negative ? -r : r);
+
+  // integer if no fraction or exponent and fits in int
+  isReal_    = true;
+  isInteger_ = (std::find_if(s, e, [](char c) { return ! isdigit(c); }) == e &&
+                r <= double(INT_MAX));
+
+  // only input strings compare as numbers
+  if (strNum_)
+    type_ = Type::STRNUM;
+}
+
+// format number as string (using CONVFMT)
+void
+CAwkValue::
+format() const
+{
+  const auto &convfmt = CAwkInst->getCONVFMT();
+
+  str_.clear();
+
+  convfmt.append(str_, real_);
+
+  strValid_ = true;
+
+  // integer string form does not depend on format
+  fmtId_ = (isInteger_ ? 0 : convfmt.getId());
 }
 
 int
 CAwkValue::
 cmp(CAwkValuePtr rhs) const
 {
-  if      ((     isReal() && (rhs->isReal() || rhs->isInteger())) ||
-           (rhs->isReal() && (     isReal() ||      isInteger()))) {
+  // numeric compare if both are numbers or strnums
+  if (getType() != Type::STRING && rhs->getType() != Type::STRING) {
     double real1 =      getReal();
     double real2 = rhs->getReal();
 
@@ -175,29 +344,15 @@ cmp(CAwkValuePtr rhs) const
     else if (real1 <  real2) return -1;
     else                     return  0;
   }
-  else if (isInteger() && rhs->isInteger()) {
-    double integer1 =      getInteger();
-    double integer2 = rhs->getInteger();
-
-    if      (integer1 > integer2) return  1;
-    else if (integer1 < integer2) return -1;
-    else                          return  0;
-  }
-  else if (isBool   () && rhs->isBool   ()) {
-    bool bool1 =      getBool();
-    bool bool2 = rhs->getBool();
-
-    if      (bool1 >  bool2) return  1;
-    else if (bool1 <  bool2) return -1;
-    else                     return  0;
-  }
   else {
-    std::string str1 =      getString();
-    std::string str2 = rhs->getString();
+    const auto &str1 =      getString();
+    const auto &str2 = rhs->getString();
+
+    int rc = str1.compare(str2);
 
-    if      (str1 >  str2) return  1;
-    else if (str1 <  str2) return -1;
-    else                   return  0;
+    if      (rc > 0) return  1;
+    else if (rc < 0) return -1;
+    else             return  0;
   }
 }
 
@@ -212,5 +367,90 @@ print(std::ostream &os) const
   else if (isBool())
     os << (getBool() ? "1" : "0");
   else
-    os << "\"" << value_ << "\"";
+    os << "\"" << str_ << "\"";
+}
+
+//----
+
+CAwkRegExpValue::
+CAwkRegExpValue(const std::string &regexp) :
+ CAwkValue(regexp)
+{
+  regexp_ = std::make_shared<CAwkRegExp>(regexp);
+}
+
+void
+CAwkRegExpValue::
+print(std::ostream &os) const
+{
+  os << "/" << getString() << "/";
+}
+
+//----
+
+void
+CAwkNumberFormat::
+setFormat(const std::string &format)
+{
+  static uint lastId;
+
+  format_ = format;
+  id_     = ++lastId;
+  prec_   = -1;
+
+  // check for %g or %.<n>g
+  if (format_ == "%g") {
+    prec_ = 6;
+    return;
+  }
+
+  auto len = format_.size();
+
+  if (len < 4 || format_[0] != '%' || format_[1] != '.' || format_[len - 1] != 'g')
+    return;
+
+  int prec = 0;
+
+  for (size_t i = 2; i < len - 1; ++i) {
+    if (! isdigit(format_[i]))
+      return;
+
+    prec = 10*prec + (format_[i] - '0');
+
+    if (prec > 99)
+      return;
+  }
+
+  prec_ = std::max(prec, 1);
+}
+
+void
+CAwkNumberFormat::
+append(std::string &str, double r) const
+{
+  char buffer[256];
+
+  // integral values output as integers
+  if (std::abs(r) < 1e16 && r == double(long(r))) {
+    auto res = std::to_chars(buffer, buffer + sizeof(buffer), long(r));
+
+    str.append(buffer, size_t(res.ptr - buffer));
+
+    return;
+  }
+
+  if (prec_ > 0) {
+    auto res = std::to_chars(buffer, buffer + sizeof(buffer), r,
+                             std::chars_format::general, prec_);
+
+    if (res.ec == std::errc()) {
+      str.append(buffer, size_t(res.ptr - buffer));
+      return;
+    }
+  }
+
+  int n = ::snprintf(buffer, sizeof(buffer), format_.c_str(), r);
+
+  if (n > 0)
+    str.append(buffer, std::min(size_t(n), sizeof(buffer) - 1));
 }
@@ -1,40 +1,67 @@
 #include <CAwk.h>
 #include <CFuncs.h>
 
-void
+int
 CAwkVariableMgr::
 addVariable(const std::string &name, const std::string &value)
 {
-  addVariable(CAwkVariable::create(name, value));
+  return addVariable(CAwkVariable::create(name, value));
 }
 
-void
+int
 CAwkVariableMgr::
 addVariable(CAwkVariablePtr var)
 {
-  variableMap_[var->getName()] = var;
+  // replace existing variable in same slot
+  auto p = slotMap_.find(var->getName());
+
+  if (p != slotMap_.end()) {
+    variables_[p->second] = var;
+
+    return p->second;
+  }
+
+  int slot = int(variables_.size());
+
+  variables_.push_back(var);
+
+  slotMap_[var->getName()] = slot;
+
+  return slot;
 }
 
 CAwkVariablePtr
 CAwkVariableMgr::
 getVariable(const std::string &name) const
 {
-  auto p = variableMap_.find(name);
+  auto p = slotMap_.find(name);
 
-  if (p != variableMap_.end())
-    return p->second;
+  if (p != slotMap_.end())
+    return variables_[p->second];
 
   return CAwkVariablePtr();
 }
 
+int
+CAwkVariableMgr::
+getSlot(const std::string &name) const
+{
+  auto p = slotMap_.find(name);
+
+  if (p != slotMap_.end())
+    return p->second;
+
+  return -1;
+}
+
 void
 CAwkVariableMgr::
 print(std::ostream &os) const
 {
   CPrintSeparated<CAwkVariable> ps(os);
 
-  for (const auto &v : variableMap_)
-    ps(v.second.get());
+  for (const auto &v : slotMap_)
+    ps(variables_[v.second].get());
 }
 
 //-------------
@@ -205,6 +232,138 @@ print(std::ostream &os) const
 
 //-----------
 
+void
+CAwkCONVFMTVariable::
+setValue(CAwkValuePtr value)
+{
+  CAwkVariable::setValue(value);
+
+  CAwkInst->setCONVFMT(value->getString());
+}
+
+//-----------
+
+CAwkValuePtr
+CAwkFNRVariable::
+getValue() const
+{
+  auto value = CAwkVariable::getValue();
+
+  value->setInteger(CAwkInst->getFNR());
+
+  return value;
+}
+
+void
+CAwkFNRVariable::
+setValue(CAwkValuePtr value)
+{
+  CAwkVariable::setValue(value);
+
+  CAwkInst->setFNR(value->getInteger());
+}
+
+//-----------
+
+void
+CAwkFSVariable::
+setValue(CAwkValuePtr value)
+{
+  CAwkVariable::setValue(value);
+
+  CAwkInst->setFS(value->getString());
+}
+
+//-----------
+
+CAwkValuePtr
+CAwkNFVariable::
+getValue() const
+{
+  auto value = CAwkVariable::getValue();
+
+  value->setInteger(CAwkInst->getNF());
+
+  return value;
+}
+
+void
+CAwkNFVariable::
+setValue(CAwkValuePtr value)
+{
+  CAwkVariable::setValue(value);
+
+  CAwkInst->setNF(value->getInteger());
+}
+
+//-----------
+
+CAwkValuePtr
+CAwkNRVariable::
+getValue() const
+{
+  auto value = CAwkVariable::getValue();
+
+  value->setInteger(CAwkInst->getNR());
+
+  return value;
+}
+
+void
+CAwkNRVariable::
+setValue(CAwkValuePtr value)
+{
+  CAwkVariable::setValue(value);
+
+  CAwkInst->setNR(value->getInteger());
+}
+
+//-----------
+
+void
+CAwkOFMTVariable::
+setValue(CAwkValuePtr value)
+{
+  CAwkVariable::setValue(value);
+
+  CAwkInst->setOFMT(value->getString());
+}
+
+//-----------
+
+void
+CAwkOFSVariable::
+setValue(CAwkValuePtr value)
+{
+  CAwkVariable::setValue(value);
+
+  CAwkInst->setOFS(value->getString());
+}
+
+//-----------
+
+void
+CAwkORSVariable::
+setValue(CAwkValuePtr value)
+{
+  CAwkVariable::setValue(value);
+
+  CAwkInst->setORS(value->getString());
+}
+
+//-----------
+
+void
+CAwkRSVariable::
+setValue(CAwkValuePtr value)
+{
+  CAwkVariable::setValue(value);
+
+  CAwkInst->setRS(value->getString());
+}
+
+//-----------
+
 CAwkVariableRef::
 ~CAwkVariableRef()
 {
@@ -221,14 +380,14 @@ CAwkValuePtr
 CAwkVariableRef::
 getValue() const
 {
-  return CAwkInst->getVariable(name_, true)->getValue();
+  return getVariable()->getValue();
 }
 
 void
 CAwkVariableRef::
 setValue(CAwkValuePtr value)
 {
-  CAwkInst->getVariable(name_, true)->setValue(value);
+  getVariable()->setValue(value);
 }
 
 bool
@@ -236,7 +395,7 @@ CAwkVariableRef::
 isInd(const std::string &ind) const
 {
   // TODO: create ?
-  return CAwkInst->getVariable(name_, true)->isInd(ind);
+  return getVariable()->isInd(ind);
 }
 
 void
@@ -244,7 +403,7 @@ CAwkVariableRef::
 removeInd(const std::string &ind)
 {
   // TODO: create ?
-  return CAwkInst->getVariable(name_, true)->removeInd(ind);
+  return getVariable()->removeInd(ind);
 }
 
 CAwkValuePtr
@@ -252,14 +411,14 @@ CAwkVariableRef::
 getIndValue(const std::string &ind) const
 {
   // TODO: create ?
-  return CAwkInst->getVariable(name_, true)->getIndValue(ind);
+  return getVariable()->getIndValue(ind);
 }
 
 void
 CAwkVariableRef::
 setIndValue(const std::string &ind, CAwkValuePtr value)
 {
-  CAwkInst->getVariable(name_, true)->setIndValue(ind, value);
+  getVariable()->setIndValue(ind, value);
 }
 
 StringVectorT
@@ -267,7 +426,7 @@ CAwkVariableRef::
 getIndices() const
 {
   // TODO: create ?
-  return CAwkInst->getVariable(name_, true)->getIndices();
+  return getVariable()->getIndices();
 }
 
 CAwkExpressionTermPtr
@@ -277,6 +436,18 @@ execute()
   return std::static_pointer_cast<CAwkExpressionTerm>(getValue());
 }
 
+CAwkVariable *
+CAwkVariableRef::
+getVariable() const
+{
+  if      (scope_ == Scope::GLOBAL)
+    return CAwkInst->getGlobalVariable(slot_);
+  else if (scope_ == Scope::LOCAL)
+    return CAwkInst->getLocalVariable(slot_);
+  else
+    return CAwkInst->getVariable(name_, true).get();
+}
+
 void
 CAwkVariableRef::
 print(std::ostream &os) const
@@ -359,7 +530,8 @@ CAwkValuePtr
 CAwkFieldVariableRef::
 getValue() const
 {
-  return CAwkValue::create(CAwkInst->getLineField(pos_));
+  // field is only copied into the value (no temporary substring)
+  return CAwkValue::createStrNum(CAwkInst->getLineField(pos_));
 }
 
 void
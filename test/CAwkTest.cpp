@@ -1,5 +1,6 @@
 #include <CAwk.h>
 #include <CFile.h>
+#include <cstdlib>
 #include <cstring>
 
 int
@@ -9,7 +10,12 @@ main(int argc, char **argv)
   std::string               progFile;
   std::string               progText;
 
-  bool debug = false;
+  bool debug   = false;
+  bool compile = true;
+  bool vm      = true;
+  bool dfa     = true;
+  bool stats   = false;
+  int  maxFiles = 0;
 
   args.push_back(argv[0]);
 
@@ -19,6 +25,16 @@ main(int argc, char **argv)
         progFile = argv[++i];
       else if (strcmp(&argv[i][1], "-debug") == 0)
         debug = true;
+      else if (strcmp(&argv[i][1], "-nocompile") == 0)
+        compile = false;
+      else if (strcmp(&argv[i][1], "-novm") == 0)
+        vm = false;
+      else if (strcmp(&argv[i][1], "-nodfa") == 0)
+        dfa = false;
+      else if (strcmp(&argv[i][1], "-stats") == 0)
+        stats = true;
+      else if (strcmp(&argv[i][1], "-maxfiles") == 0 && i < argc - 1)
+        maxFiles = atoi(argv[++i]);
       else
         std::cerr << "Invalid option '" << argv[i] << "'" << std::endl;
     }
@@ -37,6 +53,13 @@ main(int argc, char **argv)
   if (debug)
     awk->setDebug();
 
+  awk->setCompile(compile);
+  awk->setVM(vm);
+  awk->setDFA(dfa);
+
+  if (maxFiles > 0)
+    awk->setMaxOpenFiles(uint(maxFiles));
+
   if      (progFile != "") {
     if (! awk->parseFile(progFile))
       exit(1);
@@ -52,5 +75,13 @@ main(int argc, char **argv)
 
   awk->process();
 
-  return 0;
+  if (stats) {
+    const auto &regExpCache = awk->getRegExpCache();
+
+    std::cerr << "RegExp Cache: " << regExpCache.size() << " entries, " <<
+                 regExpCache.getHits() << " hits, " << regExpCache.getMisses() <<
+                 " misses" << std::endl;
+  }
+
+  return awk->getExitCode();
 }